@@ -1,3 +1,6 @@
 #pragma once
 
 #include "../src/Engine.h"
+#include "../src/EngineFarm.h"
+#include "../src/TickDriver.h"
+#include "../src/utils/MappedFile.h"
@@ -4,9 +4,13 @@
 #include <cstdint>
 
 namespace SparkWeaverCore {
+    constexpr uint32_t GAIN_UNITY = 0x10000; // Q16 gain of 1.0 for Color::scaled
+
     class Color {
     public:
-        uint8_t r, g, b;
+        uint8_t r = 0, g = 0, b = 0;
+
+        constexpr Color() = default;
 
         constexpr Color(const uint8_t red, const uint8_t green, const uint8_t blue)
             : r(red)
@@ -50,6 +54,19 @@ namespace SparkWeaverCore {
                 clamp(static_cast<float>(b) * factor)};
         }
 
+        /**
+         * @brief Integer alternative to multiplying by a float factor, results are within 1 of \c operator*(float).
+         * @param gain Factor in Q16, \c GAIN_UNITY keeps the color unchanged
+         */
+        constexpr Color scaled(const uint32_t gain) const
+        {
+            auto scale = [gain](const uint8_t value) constexpr -> uint8_t {
+                const auto result = (static_cast<uint64_t>(value) * gain + 0x8000) >> 16;
+                return result >= 0xFF ? 0xFF : static_cast<uint8_t>(result);
+            };
+            return {scale(r), scale(g), scale(b)};
+        }
+
         constexpr bool operator==(const Color& other) const { return r == other.r && g == other.g && b == other.b; }
     };
 
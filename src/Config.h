@@ -3,14 +3,19 @@
 #include <cstdint>
 
 namespace SparkWeaverCore {
-    constexpr int      PARAMS_MAX_COUNT    = 4;
-    constexpr uint16_t PARAM_MAX_VALUE     = UINT16_MAX;
-    constexpr int      DMX_PACKET_SIZE     = 513;
-    constexpr int      MAXIMUM_CONNECTIONS = 32;
-    constexpr uint8_t  TREE_VERSION        = 0x03;
+    constexpr int      PARAMS_MAX_COUNT     = 4;
+    constexpr uint16_t PARAM_MAX_VALUE      = UINT16_MAX;
+    constexpr int      DMX_PACKET_SIZE      = 513;
+    constexpr int      UNIVERSES_MAX        = 64;
+    constexpr int      MAXIMUM_CONNECTIONS  = 32;
+    constexpr uint8_t  TREE_VERSION         = 0x03;
+    constexpr uint8_t  COMPACT_TREE_VERSION = 0x05;
+    constexpr uint8_t  PATCH_VERSION        = 0x01;
+    constexpr uint8_t  STATE_VERSION        = 0x03;
 
     namespace TypeIds {
-        constexpr uint8_t DsDmxRgb = 0x00;
+        constexpr uint8_t DsDmxRgb         = 0x00;
+        constexpr uint8_t DsDmxRgbUniverse = 0x01;
 
         constexpr uint8_t FxBreathe = 0x20;
         constexpr uint8_t FxPulse   = 0x21;
@@ -37,4 +42,17 @@ namespace SparkWeaverCore {
         constexpr uint8_t ColorLinks   = 0xFE;
         constexpr uint8_t TriggerLinks = 0xFF;
     }
+
+    namespace CompactTreeFlags {
+        constexpr uint8_t Order = 0x01;
+    }
+
+    namespace PatchCommandIds {
+        constexpr uint8_t AddNode           = 0x01;
+        constexpr uint8_t RemoveNode        = 0x02;
+        constexpr uint8_t AddColorLink      = 0x03;
+        constexpr uint8_t RemoveColorLink   = 0x04;
+        constexpr uint8_t AddTriggerLink    = 0x05;
+        constexpr uint8_t RemoveTriggerLink = 0x06;
+    }
 }
@@ -1,44 +1,535 @@
 #include "Engine.h"
 
+#include <algorithm>
 #include <cstdint>
-#include <cstring>
-#include <set>
-
-#include <utils/SafeVectorReader.h>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <ranges>
+#ifdef SPARKWEAVER_CORE_PROFILE
+#include <chrono>
+#endif
 
 namespace SparkWeaverCore {
+    namespace {
+        std::span<NodeLinkColor*>&   inputsOf(const NodeLinkColor* p_link) { return p_link->getInput()->color_inputs; }
+        std::span<NodeLinkTrigger*>& inputsOf(const NodeLinkTrigger* p_link)
+        {
+            return p_link->getInput()->trigger_inputs;
+        }
+
+        uint16_t& capacityOf(const NodeLinkColor* p_link) { return p_link->getInput()->color_inputs_capacity; }
+        uint16_t& capacityOf(const NodeLinkTrigger* p_link) { return p_link->getInput()->trigger_inputs_capacity; }
+
+        uint8_t& outputsCountOf(const NodeLinkColor* p_link) { return p_link->getOutput()->color_outputs_count; }
+        uint8_t& outputsCountOf(const NodeLinkTrigger* p_link) { return p_link->getOutput()->trigger_outputs_count; }
+
+        // Signed differences as varints, small values of both signs take one byte
+        void writeDelta(std::vector<uint8_t>& bytes, const int64_t delta)
+        {
+            writeVarint(bytes, static_cast<uint32_t>(delta < 0 ? -2 * delta - 1 : 2 * delta));
+        }
+
+        int64_t decodeDelta(const uint32_t value)
+        {
+            return value & 1 ? -static_cast<int64_t>(value >> 1) - 1 : static_cast<int64_t>(value >> 1);
+        }
+
+        // Parameters are checked once when read, nodes divide by some of them and never check again
+        void checkParams(const size_t pos, const NodeConfig& config, NodeParams params)
+        {
+            for (auto i = 0; i < config.params_count; i++) {
+                if (params[i] < config.params[i].min || params[i] > config.params[i].max)
+                    throw InvalidTreeException(
+                        pos, std::string("Parameter ") + config.params[i].name.data() + " out of range");
+            }
+        }
+
+        // Compact trees before the delay of TrDelay grew to 16 bits, it takes a single byte there
+        constexpr uint8_t COMPACT_TREE_VERSION_BYTE_DELAY = 0x04;
+    }
+
+    const NodeInfo* Engine::findNode(const uint8_t type_id) noexcept
+    {
+        // Indexed by type id so parsing does not hash every node command
+        static const auto table = [] {
+            std::array<const NodeInfo*, UINT8_MAX + 1> nodes{};
+            for (const auto& [id, info] : node_registry)
+                nodes[id] = &info;
+            return nodes;
+        }();
+        return table[type_id];
+    }
+
     const NodeConfig* Engine::getNodeConfig(const uint8_t type_id) noexcept
     {
-        if (const auto pair = node_registry.find(type_id); pair != node_registry.end()) return pair->second.config;
-        return nullptr;
+        const auto p_info = findNode(type_id);
+        return p_info == nullptr ? nullptr : p_info->config;
     }
 
-    Node* Engine::makeNode(const uint8_t type_id, NodeParams params) noexcept
+    Node* Engine::addNode(const uint8_t type_id, NodeParams params)
     {
-        if (const auto pair = node_registry.find(type_id); pair != node_registry.end())
-            return pair->second.ctor(params);
-        return nullptr;
+        const auto p_info = findNode(type_id);
+        if (p_info == nullptr) return nullptr;
+
+        if (p_random == nullptr) p_random = arena.create<RandomGenerator>(random_seed);
+        const auto p_node = p_info->ctor(arena, params);
+        p_node->index      = all_nodes.size();
+        p_node->p_random   = p_random;
+        p_node->p_schedule = p_schedule.get();
+        p_node->storage    = arena.createArray<uint64_t>(p_node->getStorageSize(), 0);
+        all_nodes.push_back(p_node);
+
+        // If node has no outputs add it to root nodes
+        if (p_info->config->color_outputs == ColorOutputs::DISABLED &&
+            p_info->config->trigger_outputs == TriggerOutputs::DISABLED)
+            root_nodes.push_back(p_node);
+        return p_node;
     }
 
     void Engine::reset() noexcept
     {
-        for (const auto color_link : color_links)
-            delete color_link;
         color_links.clear();
-
-        for (const auto trigger_link : trigger_links)
-            delete trigger_link;
         trigger_links.clear();
-
-        for (const auto all_node : all_nodes)
-            delete all_node;
         all_nodes.clear();
         root_nodes.clear();
 
+        execution_plan.clear();
+        full_plan.clear();
+        selects_inputs = false;
+        dead_nodes.clear();
+        trigger_nodes.clear();
+        trigger_starts.fill(0);
+        trigger_plan.clear();
+        trigger_plan_starts.clear();
+        trigger_positions.clear();
+        step_readers.clear();
+        step_readers_starts.clear();
+        active_triggers.clear();
+        fired_slots.clear();
+        p_schedule->clear();
+        dropParams();
+        color_values   = {};
+        trigger_values = {};
+        p_random       = nullptr;
+
+        arena.clear();
+        dmx_data.assign(DMX_PACKET_SIZE, 0);
+        dmx_previous.assign(DMX_PACKET_SIZE, 0);
+        dmx_template.assign(DMX_PACKET_SIZE, 0);
+        used_channels.clear();
+#ifdef SPARKWEAVER_CORE_PROFILE
+        node_profiles.clear();
+#endif
         current_tick = 0;
     }
 
-    Engine::~Engine() { reset(); }
+    void Engine::connectLinks()
+    {
+        // Size input lists to the highest connected index, input indexes are bytes so counts go up to 256
+        std::vector<uint16_t> color_counts(all_nodes.size(), 0);
+        std::vector<uint16_t> trigger_counts(all_nodes.size(), 0);
+        for (const auto p_link : color_links) {
+            auto& count = color_counts[p_link->getInput()->index];
+            count       = std::max<uint16_t>(count, p_link->getInputIndex() + 1u);
+        }
+        for (const auto p_link : trigger_links) {
+            auto& count = trigger_counts[p_link->getInput()->index];
+            count       = std::max<uint16_t>(count, p_link->getInputIndex() + 1u);
+        }
+
+        for (const auto p_node : all_nodes) {
+            const auto color_count          = color_counts[p_node->index];
+            const auto trigger_count        = trigger_counts[p_node->index];
+            p_node->color_inputs            = arena.createArray<NodeLinkColor*>(color_count, nullptr);
+            p_node->trigger_inputs          = arena.createArray<NodeLinkTrigger*>(trigger_count, nullptr);
+            p_node->color_inputs_capacity   = color_count;
+            p_node->trigger_inputs_capacity = trigger_count;
+        }
+
+        for (const auto p_link : color_links)
+            p_link->connect();
+        for (const auto p_link : trigger_links)
+            p_link->connect();
+    }
+
+    void Engine::searchOrder(const size_t pos, std::vector<Node*>& order) const
+    {
+        const auto nodes_count = all_nodes.size();
+
+        // Iterative depth-first search, a node is emitted after all nodes it reads from
+        enum class Mark : uint8_t { NONE, VISITING, DONE };
+        std::vector<Mark>                       marks(nodes_count, Mark::NONE);
+        std::vector<std::pair<size_t, size_t>> stack;
+
+        auto visit = [&](const size_t start) {
+            if (marks[start] != Mark::NONE) return;
+            marks[start] = Mark::VISITING;
+            stack.emplace_back(start, 0);
+            while (!stack.empty()) {
+                const auto [node_index, input] = stack.back();
+                const auto p_node              = all_nodes[node_index];
+                const auto color_count         = p_node->color_inputs.size();
+                if (input == color_count + p_node->trigger_inputs.size()) {
+                    marks[node_index] = Mark::DONE;
+                    order.push_back(p_node);
+                    stack.pop_back();
+                    continue;
+                }
+                stack.back().second++;
+
+                const Node* p_output;
+                if (input < color_count) {
+                    if (p_node->color_inputs[input] == nullptr)
+                        throw InvalidTreeException(
+                            pos, std::string("Color input not connected to ") + p_node->getConfig().name.data());
+                    p_output = p_node->color_inputs[input]->getOutput();
+                } else {
+                    if (p_node->trigger_inputs[input - color_count] == nullptr)
+                        throw InvalidTreeException(
+                            pos, std::string("Trigger input not connected to ") + p_node->getConfig().name.data());
+                    p_output = p_node->trigger_inputs[input - color_count]->getOutput();
+                }
+
+                if (marks[p_output->index] == Mark::VISITING) {
+                    // Nodes on the stack from the one reached again form the cycle
+                    auto message = std::string("Tree contains a cycle through nodes");
+                    auto it      = std::ranges::find(stack, p_output->index, &std::pair<size_t, size_t>::first);
+                    for (auto first = it; it != stack.end(); ++it)
+                        message += (it == first ? " " : ", ") + std::to_string(it->first);
+                    throw InvalidTreeException(pos, message);
+                }
+                if (marks[p_output->index] == Mark::NONE) {
+                    marks[p_output->index] = Mark::VISITING;
+                    stack.emplace_back(p_output->index, 0);
+                }
+            }
+        };
+
+        // Roots first so they render in the same order as before, then nodes not reachable from any root
+        for (const auto root_node : root_nodes)
+            visit(root_node->index);
+        for (size_t i = 0; i < nodes_count; i++)
+            visit(i);
+    }
+
+    void Engine::buildExecutionPlan(const size_t pos, const std::span<const uint32_t> evaluation_order)
+    {
+        const auto nodes_count = all_nodes.size();
+        const auto links_count = color_links.size() + trigger_links.size();
+
+        // Links grouped by output node, trigger links are numbered after color links
+        std::vector<uint32_t> links_start(nodes_count + 1, 0);
+        for (const auto p_link : color_links)
+            links_start[p_link->getOutput()->index + 1]++;
+        for (const auto p_link : trigger_links)
+            links_start[p_link->getOutput()->index + 1]++;
+        for (size_t i = 0; i < nodes_count; i++)
+            links_start[i + 1] += links_start[i];
+
+        std::vector<uint32_t> grouped_links(links_count);
+        std::vector<uint32_t> links_end(links_start.begin(), links_start.end() - 1);
+        for (uint32_t i = 0; i < color_links.size(); i++)
+            grouped_links[links_end[color_links[i]->getOutput()->index]++] = i;
+        for (uint32_t i = 0; i < trigger_links.size(); i++)
+            grouped_links[links_end[trigger_links[i]->getOutput()->index]++] = color_links.size() + i;
+
+        // One step and value slot per distinct node output, shared by every link reading from it
+        std::vector<ExecutionStep> output_steps;
+        std::vector<uint32_t>      steps_start(nodes_count + 1, 0);
+        std::vector<uint32_t>      link_slots(links_count);
+        uint32_t                   color_slots   = 0;
+        uint32_t                   trigger_slots = 0;
+        output_steps.reserve(links_count);
+
+        for (size_t node_index = 0; node_index < nodes_count; node_index++) {
+            steps_start[node_index] = output_steps.size();
+            for (auto i = links_start[node_index]; i < links_start[node_index + 1]; i++) {
+                const auto link         = grouped_links[i];
+                const auto is_color     = link < color_links.size();
+                const auto kind         = is_color ? ExecutionStep::Kind::COLOR : ExecutionStep::Kind::TRIGGER;
+                const auto output_index = is_color ? color_links[link]->getOutputIndex()
+                                                   : trigger_links[link - color_links.size()]->getOutputIndex();
+
+                auto step = steps_start[node_index];
+                while (step < output_steps.size() &&
+                       (output_steps[step].kind != kind || output_steps[step].output_index != output_index))
+                    step++;
+                if (step == output_steps.size())
+                    output_steps.push_back(
+                        {all_nodes[node_index], is_color ? color_slots++ : trigger_slots++, output_index, kind});
+                link_slots[link] = output_steps[step].slot;
+            }
+        }
+        steps_start[nodes_count] = output_steps.size();
+
+        std::vector<Node*> order;
+        order.reserve(nodes_count);
+        if (!evaluation_order.empty()) {
+            // Order given by the tree replaces the search, it only has to be checked against the links
+            if (evaluation_order.size() != nodes_count) throw InvalidTreeException(pos, "Evaluation order incomplete");
+            std::vector<uint32_t> positions(nodes_count, UINT32_MAX);
+            for (uint32_t i = 0; i < nodes_count; i++) {
+                const auto node_index = evaluation_order[i];
+                if (node_index >= nodes_count || positions[node_index] != UINT32_MAX)
+                    throw InvalidTreeException(pos, "Evaluation order is not a permutation of nodes");
+                positions[node_index] = i;
+                order.push_back(all_nodes[node_index]);
+            }
+
+            const auto check_link = [&](const auto* p_link) {
+                const auto out_node_index = p_link->getOutput()->index;
+                const auto in_node_index  = p_link->getInput()->index;
+                if (positions[out_node_index] >= positions[in_node_index])
+                    throw InvalidTreeException(
+                        pos,
+                        "Evaluation order does not follow link from node " + std::to_string(out_node_index) +
+                            " to node " + std::to_string(in_node_index));
+            };
+            std::ranges::for_each(color_links, check_link);
+            std::ranges::for_each(trigger_links, check_link);
+
+            for (const auto p_node : all_nodes) {
+                if (std::ranges::find(p_node->color_inputs, nullptr) != p_node->color_inputs.end())
+                    throw InvalidTreeException(
+                        pos, std::string("Color input not connected to ") + p_node->getConfig().name.data());
+                if (std::ranges::find(p_node->trigger_inputs, nullptr) != p_node->trigger_inputs.end())
+                    throw InvalidTreeException(
+                        pos, std::string("Trigger input not connected to ") + p_node->getConfig().name.data());
+            }
+        } else {
+            searchOrder(pos, order);
+        }
+
+        // Walking back from the roots, nodes whose outputs never reach a destination node are left out of the plan
+        std::vector<bool> live(nodes_count, false);
+        for (const auto root_node : root_nodes)
+            live[root_node->index] = true;
+        dead_nodes.clear();
+        for (auto it = order.rbegin(); it != order.rend(); ++it) {
+            const auto p_node = *it;
+            if (!live[p_node->index]) continue;
+            for (const auto* color_input : p_node->color_inputs)
+                live[color_input->getOutput()->index] = true;
+            for (const auto* trigger_input : p_node->trigger_inputs)
+                live[trigger_input->getOutput()->index] = true;
+        }
+
+        execution_plan.clear();
+        execution_plan.reserve(output_steps.size() + root_nodes.size());
+        for (const auto p_node : order) {
+            if (!live[p_node->index]) {
+                dead_nodes.push_back(p_node);
+                continue;
+            }
+            for (auto i = steps_start[p_node->index]; i < steps_start[p_node->index + 1]; i++)
+                execution_plan.push_back(output_steps[i]);
+            if (const auto& config = p_node->getConfig();
+                config.color_outputs == ColorOutputs::DISABLED && config.trigger_outputs == TriggerOutputs::DISABLED)
+                execution_plan.push_back({p_node, 0, 0, ExecutionStep::Kind::RENDER});
+        }
+
+        // Dense value table, one slot per node output, tables of a patched tree are reused if large enough
+        if (color_values.size() < color_slots) {
+            arena.release(color_values.data(), color_values.size_bytes());
+            color_values = arena.createArray(color_slots, Colors::BLACK);
+        }
+        for (size_t i = 0; i < color_links.size(); i++)
+            color_links[i]->bind(&color_values[link_slots[i]]);
+        demanded_colors.assign(color_values.size(), 0);
+
+        if (trigger_values.size() < trigger_slots) {
+            arena.release(trigger_values.data(), trigger_values.size_bytes());
+            trigger_values = arena.createArray(trigger_slots, false);
+        }
+        for (size_t i = 0; i < trigger_links.size(); i++)
+            trigger_links[i]->bind(&trigger_values[link_slots[color_links.size() + i]]);
+    }
+
+    void Engine::foldConstants() noexcept
+    {
+        enum class Folding : uint8_t { UNKNOWN, CONSTANT, DYNAMIC };
+        std::vector<Folding>      folding(all_nodes.size(), Folding::UNKNOWN);
+        std::vector<ChannelRange> dynamic_ranges;
+
+        size_t kept = 0;
+        for (const auto& step : execution_plan) {
+            if (step.kind == ExecutionStep::Kind::TRIGGER) continue; // Evaluated by evaluateTriggers when they may fire
+            const auto p_node = step.node;
+
+            // Steps of a node are consecutive and follow the steps of all its inputs
+            if (folding[p_node->index] == Folding::UNKNOWN) {
+                auto constant = p_node->isTimeInvariant() && p_node->trigger_inputs.empty();
+                for (const auto* color_input : p_node->color_inputs)
+                    constant = constant && folding[color_input->getOutput()->index] == Folding::CONSTANT;
+                folding[p_node->index] = constant ? Folding::CONSTANT : Folding::DYNAMIC;
+            }
+
+            if (folding[p_node->index] == Folding::CONSTANT) {
+                if (step.kind == ExecutionStep::Kind::COLOR) {
+                    color_values[step.slot] = p_node->getColor(current_tick, step.output_index);
+                    continue;
+                }
+                if (step.kind == ExecutionStep::Kind::RENDER) {
+                    const auto range    = p_node->getRenderRange();
+                    const auto overlaps = [&](const ChannelRange& other) { return other.overlaps(range); };
+                    if (std::ranges::none_of(dynamic_ranges, overlaps)) {
+                        p_node->render(current_tick, dmx_template.data());
+                        continue;
+                    }
+                }
+            }
+
+            if (step.kind == ExecutionStep::Kind::RENDER) dynamic_ranges.push_back(p_node->getRenderRange());
+
+            execution_plan[kept++] = step;
+        }
+        execution_plan.resize(kept);
+
+        // Colors only matter to a seek for nodes that change state while computing them
+        seek_plan.clear();
+        for (const auto& step : execution_plan) {
+            if (step.kind == ExecutionStep::Kind::COLOR && step.node->hasColorState()) seek_plan.push_back(step);
+        }
+        selects_inputs = std::ranges::any_of(execution_plan, [](const ExecutionStep& step) {
+            return step.kind == ExecutionStep::Kind::COLOR && step.node->selectsInput();
+        });
+    }
+
+    void Engine::demandColors() noexcept
+    {
+        // Readers come after the nodes they read from, walking the plan backwards settles a slot before its node
+        std::ranges::fill(demanded_colors, 0);
+        const auto demand = [this](const NodeLinkColor* p_link) {
+            demanded_colors[p_link->getSlot() - color_values.data()] = 1;
+        };
+        for (const auto& [node, slot, output_index, kind] : std::views::reverse(execution_plan)) {
+            if (kind == ExecutionStep::Kind::TRIGGER) continue;
+            if (kind == ExecutionStep::Kind::COLOR && !demanded_colors[slot]) continue;
+            if (!node->selectsInput()) {
+                std::ranges::for_each(node->color_inputs, demand);
+            } else if (!node->color_inputs.empty()) {
+                demand(node->color_inputs[node->selectInput(current_tick)]);
+            }
+        }
+    }
+
+    void Engine::buildTriggerPlan()
+    {
+        trigger_plan.clear();
+        trigger_plan_starts.clear();
+        trigger_positions.assign(all_nodes.size(), UINT32_MAX);
+        for (const auto& step : full_plan) {
+            if (step.kind != ExecutionStep::Kind::TRIGGER) continue;
+            if (auto& position = trigger_positions[step.node->index]; position == UINT32_MAX) {
+                position = trigger_plan_starts.size();
+                trigger_plan_starts.push_back(trigger_plan.size());
+            }
+            trigger_plan.push_back(step);
+        }
+        trigger_plan_starts.push_back(trigger_plan.size());
+
+        // Step read by a link, nullopt if either end is not a trigger node in the plan
+        const auto link_step = [&](const NodeLinkTrigger* p_link) -> std::optional<uint32_t> {
+            const auto out_position = trigger_positions[p_link->getOutput()->index];
+            if (out_position == UINT32_MAX || trigger_positions[p_link->getInput()->index] == UINT32_MAX)
+                return std::nullopt;
+            for (auto i = trigger_plan_starts[out_position]; i < trigger_plan_starts[out_position + 1]; i++)
+                if (trigger_plan[i].output_index == p_link->getOutputIndex()) return i;
+            return std::nullopt;
+        };
+
+        // Counting sort of the reading nodes by step
+        step_readers_starts.assign(trigger_plan.size() + 1, 0);
+        for (const auto p_link : trigger_links)
+            if (const auto step = link_step(p_link)) step_readers_starts[*step + 1]++;
+        for (size_t i = 0; i < trigger_plan.size(); i++)
+            step_readers_starts[i + 1] += step_readers_starts[i];
+
+        step_readers.resize(step_readers_starts.back());
+        auto ends = step_readers_starts;
+        for (const auto p_link : trigger_links)
+            if (const auto step = link_step(p_link))
+                step_readers[ends[*step]++] = trigger_positions[p_link->getInput()->index];
+
+        // Every step fires at most once per tick, evaluation only allocates when a node has several events in one tick
+        active_triggers.clear();
+        active_triggers.reserve(step_readers.size() + trigger_plan_starts.size());
+        // Slots of a patched tree are numbered again, a value left true by the last tick would stay true
+        std::ranges::fill(trigger_values, false);
+        fired_slots.clear();
+        fired_slots.reserve(trigger_plan.size());
+        // Nodes left dead by a patch may still have an event
+        p_schedule->reserve(std::ranges::count_if(all_nodes, [](const Node* p_node) {
+            return p_node->getConfig().trigger_outputs == TriggerOutputs::ENABLED;
+        }));
+    }
+
+    void Engine::startTriggers() noexcept
+    {
+        for (size_t position = 0; position + 1 < trigger_plan_starts.size(); position++)
+            trigger_plan[trigger_plan_starts[position]].node->start(current_tick);
+    }
+
+    bool Engine::activateTrigger(const Node* p_node) noexcept
+    {
+        const auto index = p_node->index;
+        if (index >= trigger_positions.size() || all_nodes[index] != p_node || trigger_positions[index] == UINT32_MAX)
+            return false;
+        active_triggers.push_back(trigger_positions[index]);
+        std::ranges::push_heap(active_triggers, std::greater{});
+        return true;
+    }
+
+    void Engine::evaluateTriggers() noexcept
+    {
+        for (const auto slot : fired_slots)
+            trigger_values[slot] = false;
+        fired_slots.clear();
+
+        TriggerSchedule::Event event{};
+        while (p_schedule->pop(current_tick, event)) {
+            if (activateTrigger(event.p_node)) event.p_node->wake(event.tick);
+        }
+
+        // Positions follow the evaluation order, so a node is taken after every node it reads from
+        auto previous = UINT32_MAX;
+        while (!active_triggers.empty()) {
+            std::ranges::pop_heap(active_triggers, std::greater{});
+            const auto position = active_triggers.back();
+            active_triggers.pop_back();
+            if (position == previous) continue;
+            previous = position;
+
+            for (auto i = trigger_plan_starts[position]; i < trigger_plan_starts[position + 1]; i++) {
+                const auto& [node, slot, output_index, kind] = trigger_plan[i];
+#ifdef SPARKWEAVER_CORE_PROFILE
+                const auto start = std::chrono::steady_clock::now();
+#endif
+                if (node->getTrigger(current_tick, output_index)) {
+                    trigger_values[slot] = true;
+                    fired_slots.push_back(slot);
+                    for (auto j = step_readers_starts[i]; j < step_readers_starts[i + 1]; j++) {
+                        active_triggers.push_back(step_readers[j]);
+                        std::ranges::push_heap(active_triggers, std::greater{});
+                    }
+                }
+#ifdef SPARKWEAVER_CORE_PROFILE
+                const auto elapsed = std::chrono::steady_clock::now() - start;
+                auto&      profile = node_profiles[node->index];
+                profile.evaluations++;
+                profile.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+#endif
+            }
+        }
+    }
+
+    Engine::~Engine()
+    {
+        delete staged.load();
+        delete retired.load();
+        delete p_retiring;
+    }
 
     std::vector<const NodeConfig*> Engine::getNodeConfigs() noexcept
     {
@@ -50,103 +541,993 @@ namespace SparkWeaverCore {
         return configs;
     }
 
-    void Engine::build(const std::vector<uint8_t>& tree)
+    void Engine::parseTree(SafeSpanReader& reader)
+    {
+        while (reader.hasByte()) {
+            if (const auto command = reader.readByte();
+                command == CommandIds::ColorLinks || command == CommandIds::TriggerLinks) {
+                // Get links count
+                if (!reader.hasShort()) throw InvalidTreeException(reader.position(), "Links missing length");
+                const auto count = reader.readShort();
+
+                // Read links
+                for (auto i = 0; i < count; i++) {
+                    if (!reader.hasBytes(6)) throw InvalidTreeException(reader.position(), "Link incomplete");
+                    const auto out_node_index = reader.readShort();
+                    const auto in_node_index  = reader.readShort();
+                    const auto out_index      = reader.readByte();
+                    const auto in_index       = reader.readByte();
+                    if (out_node_index >= all_nodes.size() || in_node_index >= all_nodes.size())
+                        throw InvalidTreeException(reader.position(), "Link index out of range");
+
+                    // Make link
+                    const auto p_out = all_nodes[out_node_index];
+                    const auto p_in  = all_nodes[in_node_index];
+                    if (command == CommandIds::ColorLinks)
+                        color_links.push_back(arena.create<NodeLinkColor>(p_out, p_in, out_index, in_index));
+                    else
+                        trigger_links.push_back(arena.create<NodeLinkTrigger>(p_out, p_in, out_index, in_index));
+                }
+
+            } else {
+                // Find corresponding node config
+                const auto p_config = getNodeConfig(command);
+                if (p_config == nullptr) throw InvalidTreeException(reader.position(), "Unknown command");
+
+                // Read params
+                std::array<uint16_t, PARAMS_MAX_COUNT> params = {};
+                for (auto i = 0; i < p_config->params_count; i++) {
+                    if (!reader.hasShort()) throw InvalidTreeException(reader.position(), "Missing parameter");
+                    params[i] = reader.readShort();
+                }
+                checkParams(reader.position(), *p_config, params);
+
+                addNode(command, params);
+            }
+        }
+    }
+
+    void Engine::parseCompactTree(SafeSpanReader& reader, std::vector<uint32_t>& order, const uint8_t version)
+    {
+        // Header
+        if (!reader.hasVarint()) throw InvalidTreeException(reader.position(), "Missing nodes count");
+        const auto nodes_count = reader.readVarint();
+        if (!reader.hasVarint()) throw InvalidTreeException(reader.position(), "Missing color links count");
+        const auto color_links_count = reader.readVarint();
+        if (!reader.hasVarint()) throw InvalidTreeException(reader.position(), "Missing trigger links count");
+        const auto trigger_links_count = reader.readVarint();
+        if (!reader.hasByte()) throw InvalidTreeException(reader.position(), "Missing flags");
+        const auto flags = reader.readByte();
+
+        // Every node takes at least one byte and every link three, so counts cannot reserve more than the tree holds
+        if (nodes_count + 3ull * (color_links_count + trigger_links_count) > reader.remaining())
+            throw InvalidTreeException(reader.position(), "Counts exceed tree size");
+        all_nodes.reserve(nodes_count);
+        color_links.reserve(color_links_count);
+        trigger_links.reserve(trigger_links_count);
+
+        // Nodes
+        for (uint32_t n = 0; n < nodes_count; n++) {
+            if (!reader.hasByte()) throw InvalidTreeException(reader.position(), "Node missing");
+            const auto type_id  = reader.readByte();
+            const auto p_config = getNodeConfig(type_id);
+            if (p_config == nullptr) throw InvalidTreeException(reader.position(), "Unknown node type");
+
+            // Parameters limited to a byte take one byte, others are varints
+            std::array<uint16_t, PARAMS_MAX_COUNT> params = {};
+            for (auto i = 0; i < p_config->params_count; i++) {
+                if (p_config->params[i].max <= UINT8_MAX ||
+                    (version == COMPACT_TREE_VERSION_BYTE_DELAY && type_id == TypeIds::TrDelay)) {
+                    if (!reader.hasByte()) throw InvalidTreeException(reader.position(), "Missing parameter");
+                    params[i] = reader.readByte();
+                    continue;
+                }
+                if (!reader.hasVarint()) throw InvalidTreeException(reader.position(), "Missing parameter");
+                const auto value = reader.readVarint();
+                if (value > PARAM_MAX_VALUE) throw InvalidTreeException(reader.position(), "Parameter too large");
+                params[i] = static_cast<uint16_t>(value);
+            }
+            checkParams(reader.position(), *p_config, params);
+
+            addNode(type_id, params);
+        }
+
+        // Links, input node is relative to the previous link and output node to the input node, output and input
+        // index are packed in a single varint with the output index, usually 0, in the high byte
+        int64_t in_node_index = 0;
+        for (uint32_t i = 0; i < color_links_count + trigger_links_count; i++) {
+            if (!reader.hasVarint()) throw InvalidTreeException(reader.position(), "Link incomplete");
+            in_node_index += decodeDelta(reader.readVarint());
+            if (!reader.hasVarint()) throw InvalidTreeException(reader.position(), "Link incomplete");
+            const auto out_node_index = in_node_index + decodeDelta(reader.readVarint());
+            if (!reader.hasVarint()) throw InvalidTreeException(reader.position(), "Link incomplete");
+            const auto indexes = reader.readVarint();
+            if (const auto nodes = static_cast<int64_t>(all_nodes.size());
+                out_node_index < 0 || out_node_index >= nodes || in_node_index < 0 || in_node_index >= nodes)
+                throw InvalidTreeException(reader.position(), "Link index out of range");
+            if (indexes > UINT16_MAX) throw InvalidTreeException(reader.position(), "Link output index out of range");
+            const auto out_index = static_cast<uint8_t>(indexes >> 8);
+            const auto in_index  = static_cast<uint8_t>(indexes & 0xFF);
+
+            const auto p_out = all_nodes[out_node_index];
+            const auto p_in  = all_nodes[in_node_index];
+            if (i < color_links_count)
+                color_links.push_back(arena.create<NodeLinkColor>(p_out, p_in, out_index, in_index));
+            else
+                trigger_links.push_back(arena.create<NodeLinkTrigger>(p_out, p_in, out_index, in_index));
+        }
+
+        // Evaluation order relative to the previous node, checked against the links when the execution plan is built
+        if (flags & CompactTreeFlags::Order) {
+            order.resize(nodes_count);
+            int64_t node_index = 0;
+            for (auto& entry : order) {
+                if (!reader.hasVarint()) throw InvalidTreeException(reader.position(), "Evaluation order incomplete");
+                node_index += decodeDelta(reader.readVarint());
+                if (node_index < 0 || node_index >= nodes_count)
+                    throw InvalidTreeException(reader.position(), "Evaluation order index out of range");
+                entry = static_cast<uint32_t>(node_index);
+            }
+        }
+
+        if (reader.hasByte()) throw InvalidTreeException(reader.position(), "Unexpected data after tree");
+    }
+
+    void Engine::build(const std::span<const uint8_t> tree)
     {
         reset();
 
         try {
-            SafeVectorReader reader(tree);
+            SafeSpanReader reader(tree);
 
             // Check version
             if (!reader.hasByte()) throw InvalidTreeException(0, "Tree is empty");
-            if (reader.readByte() != TREE_VERSION)
+            std::vector<uint32_t> order;
+            switch (reader.readByte()) {
+            case TREE_VERSION:
+                parseTree(reader);
+                break;
+            case COMPACT_TREE_VERSION_BYTE_DELAY:
+            case COMPACT_TREE_VERSION:
+                parseCompactTree(reader, order, tree[0]);
+                break;
+            default:
                 throw InvalidTreeException(reader.position(), "Incompatible tree version");
+            }
 
-            // Parse commands
-            while (reader.hasByte()) {
-                if (const auto command = reader.readByte();
-                    command == CommandIds::ColorLinks || command == CommandIds::TriggerLinks) {
-                    // Get links count
-                    if (!reader.hasShort()) throw InvalidTreeException(reader.position(), "Links missing length");
-                    const auto count = reader.readShort();
-
-                    // Read links
-                    for (auto i = 0; i < count; i++) {
-                        if (!reader.hasBytes(6)) throw InvalidTreeException(reader.position(), "Link incomplete");
-                        const auto out_node_index = reader.readShort();
-                        const auto in_node_index  = reader.readShort();
-                        const auto out_index      = reader.readByte();
-                        const auto in_index       = reader.readByte();
-                        if (out_node_index >= all_nodes.size() || in_node_index >= all_nodes.size())
-                            throw InvalidTreeException(reader.position(), "Link index out of range");
-
-                        // Make link
-                        const auto p_out = all_nodes[out_node_index];
-                        const auto p_in  = all_nodes[in_node_index];
-                        if (command == CommandIds::ColorLinks)
-                            color_links.emplace_back(new NodeLinkColor(p_out, p_in, out_index, in_index));
-                        else
-                            trigger_links.emplace_back(new NodeLinkTrigger(p_out, p_in, out_index, in_index));
-                    }
+            connectLinks();
+            buildExecutionPlan(reader.position(), order);
 
-                } else {
-                    // Find corresponding node config
-                    const auto p_config = getNodeConfig(command);
-                    if (p_config == nullptr) throw InvalidTreeException(reader.position(), "Unknown command");
+            finishBuild();
+        } catch (...) {
+            reset();
+            throw;
+        }
+    }
+
+    size_t Engine::countUniverses() const noexcept
+    {
+        // Allocate all universes addressed by destination nodes
+        size_t universes_count = 1;
+        for (const auto root_node : root_nodes) {
+            if (const auto universe = root_node->getParam(1);
+                root_node->getConfig().type_id == TypeIds::DsDmxRgbUniverse && universe < UNIVERSES_MAX)
+                universes_count = std::max<size_t>(universes_count, universe + 1);
+        }
+        return universes_count;
+    }
+
+    void Engine::finishBuild()
+    {
+        const auto size = countUniverses() * DMX_PACKET_SIZE;
+        dmx_data.assign(size, 0);
+        dmx_previous.assign(size, 0);
+        dmx_template.assign(size, 0);
+
+        finishPlan();
+
+#ifdef SPARKWEAVER_CORE_PROFILE
+        node_profiles.clear();
+        node_profiles.reserve(all_nodes.size());
+        for (const auto p_node : all_nodes)
+            node_profiles.push_back({p_node->index, p_node->getConfig().type_id, 0, 0});
+#endif
+    }
+
+    void Engine::finishPatch(const std::span<Node* const> previous_nodes)
+    {
+        // Frames are kept so changed channels only show what the patch changed, resizing keeps the bytes of every
+        // universe still rendered
+        if (const auto size = countUniverses() * DMX_PACKET_SIZE; size != dmx_data.size()) {
+            dmx_data.resize(size, 0);
+            dmx_previous.resize(size, 0);
+            dmx_template.resize(size, 0);
+        }
+
+        finishPlan();
+
+#ifdef SPARKWEAVER_CORE_PROFILE
+        // Counters follow their node to its new index, added nodes start from zero
+        std::unordered_map<const Node*, NodeProfile> previous_profiles;
+        for (size_t i = 0; i < previous_nodes.size() && i < node_profiles.size(); i++)
+            previous_profiles.emplace(previous_nodes[i], node_profiles[i]);
+        node_profiles.clear();
+        node_profiles.reserve(all_nodes.size());
+        for (const auto p_node : all_nodes) {
+            const auto previous = previous_profiles.find(p_node);
+            node_profiles.push_back(
+                {p_node->index,
+                 p_node->getConfig().type_id,
+                 previous == previous_profiles.end() ? 0 : previous->second.evaluations,
+                 previous == previous_profiles.end() ? 0 : previous->second.nanoseconds});
+        }
+#endif
+    }
+
+    void Engine::finishPlan()
+    {
+        used_channels.assign(getUniverseCount(), {});
+        computeUsedChannels();
+
+        full_plan = execution_plan;
+        buildTriggerPlan();
+        std::ranges::fill(dmx_template, 0);
+        seek_plan.reserve(full_plan.size()); // Folding again after a parameter change does not allocate
+        foldConstants();
+        indexExternalTriggers();
+        startTriggers();
+    }
+
+    template <typename Link>
+    void Engine::attachLink(Link* p_link, std::vector<Link*>& links)
+    {
+        auto&      inputs   = inputsOf(p_link);
+        auto&      capacity = capacityOf(p_link);
+        const auto size     = std::max<size_t>(inputs.size(), p_link->getInputIndex() + 1u);
+        if (size > capacity) {
+            const auto grown = arena.createArray<Link*>(size, nullptr);
+            std::ranges::copy(inputs, grown.begin());
+            arena.release(inputs.data(), capacity * sizeof(Link*));
+            inputs   = grown;
+            capacity = size;
+        }
+        // Inputs past the end up to the capacity were dropped as empty and are still nullptr
+        inputs = {inputs.data(), size};
+        p_link->connect();
+        links.push_back(p_link);
+    }
+
+    template <typename Link>
+    void Engine::detachLink(Link* p_link, std::vector<Link*>& links) noexcept
+    {
+        auto& inputs                    = inputsOf(p_link);
+        inputs[p_link->getInputIndex()] = nullptr;
+        while (!inputs.empty() && inputs.back() == nullptr)
+            inputs = inputs.first(inputs.size() - 1);
+
+        // Link order does not matter, the execution plan is built again after a patch
+        const auto position = std::ranges::find(links, p_link);
+        *position           = links.back();
+        links.pop_back();
+    }
+
+    void Engine::removeNode(const size_t index, std::vector<PatchUndo>& undo)
+    {
+        const auto p_node = all_nodes[index];
+
+        // Backwards so links moved into a removed position are already checked
+        for (auto i = color_links.size(); i-- > 0;) {
+            if (const auto p_link = color_links[i]; p_link->getOutput() == p_node || p_link->getInput() == p_node) {
+                detachLink(p_link, color_links);
+                outputsCountOf(p_link)--;
+                undo.push_back({PatchUndo::Kind::REMOVE_COLOR_LINK, nullptr, p_link});
+            }
+        }
+        for (auto i = trigger_links.size(); i-- > 0;) {
+            if (const auto p_link = trigger_links[i]; p_link->getOutput() == p_node || p_link->getInput() == p_node) {
+                detachLink(p_link, trigger_links);
+                outputsCountOf(p_link)--;
+                undo.push_back({PatchUndo::Kind::REMOVE_TRIGGER_LINK, nullptr, nullptr, p_link});
+            }
+        }
+
+        all_nodes.erase(all_nodes.begin() + index);
+        for (auto i = index; i < all_nodes.size(); i++)
+            all_nodes[i]->index = i;
+        if (const auto root = std::ranges::find(root_nodes, p_node); root != root_nodes.end()) root_nodes.erase(root);
+        undo.push_back({PatchUndo::Kind::REMOVE_NODE, p_node, nullptr, nullptr, static_cast<uint32_t>(index)});
+    }
+
+    void Engine::undoPatch(const std::vector<PatchUndo>& undo) noexcept
+    {
+        for (auto change = undo.rbegin(); change != undo.rend(); ++change) {
+            switch (change->kind) {
+            case PatchUndo::Kind::ADD_NODE:
+                if (!root_nodes.empty() && root_nodes.back() == all_nodes.back()) root_nodes.pop_back();
+                all_nodes.pop_back();
+                break;
+            case PatchUndo::Kind::REMOVE_NODE: {
+                all_nodes.insert(all_nodes.begin() + change->index, change->node);
+                for (auto i = change->index; i < all_nodes.size(); i++)
+                    all_nodes[i]->index = i;
+                const auto& config = change->node->getConfig();
+                if (config.color_outputs == ColorOutputs::DISABLED &&
+                    config.trigger_outputs == TriggerOutputs::DISABLED)
+                    root_nodes.insert(
+                        std::ranges::lower_bound(root_nodes, change->index, {}, [](const Node* p) { return p->index; }),
+                        change->node);
+                break;
+            }
+            case PatchUndo::Kind::ADD_COLOR_LINK:
+                detachLink(change->color_link, color_links);
+                outputsCountOf(change->color_link)--;
+                break;
+            case PatchUndo::Kind::REMOVE_COLOR_LINK:
+                outputsCountOf(change->color_link)++;
+                attachLink(change->color_link, color_links); // Input was free before the patch
+                break;
+            case PatchUndo::Kind::ADD_TRIGGER_LINK:
+                detachLink(change->trigger_link, trigger_links);
+                outputsCountOf(change->trigger_link)--;
+                break;
+            case PatchUndo::Kind::REMOVE_TRIGGER_LINK:
+                outputsCountOf(change->trigger_link)++;
+                attachLink(change->trigger_link, trigger_links);
+                break;
+            }
+        }
+    }
+
+    void Engine::computeUsedChannels() noexcept
+    {
+        // Ranges never cross universes
+        std::ranges::fill(used_channels, ChannelRange{});
+        for (const auto root_node : root_nodes) {
+            const auto range = root_node->getRenderRange();
+            if (range.empty()) continue;
+            const auto offset = range.start / DMX_PACKET_SIZE * DMX_PACKET_SIZE;
+            auto&      used   = used_channels[range.start / DMX_PACKET_SIZE];
+            used.start        = used.empty() ? range.start - offset : std::min(used.start, range.start - offset);
+            used.end          = std::max(used.end, range.end - offset);
+        }
+    }
+
+    void Engine::indexExternalTriggers()
+    {
+        // Counting sort by id, the node count only changes with the tree
+        trigger_starts.fill(0);
+        size_t count = 0;
+        for (const auto p_node : all_nodes) {
+            if (p_node->getConfig().type_id != TypeIds::SrTrigger) continue;
+            trigger_starts[p_node->getParam(0) + 1]++;
+            count++;
+        }
+        for (size_t id = 0; id < trigger_starts.size() - 1; id++)
+            trigger_starts[id + 1] += trigger_starts[id];
+
+        trigger_nodes.resize(count);
+        auto ends = trigger_starts;
+        for (const auto p_node : all_nodes)
+            if (p_node->getConfig().type_id == TypeIds::SrTrigger) trigger_nodes[ends[p_node->getParam(0)]++] = p_node;
+    }
+
+    void Engine::applyParams() noexcept
+    {
+        auto fold     = false;
+        auto render   = false;
+        auto triggers = false;
+        // At most one queue length, changes pushed while draining wait for the next tick
+        ParamChange change;
+        for (size_t i = 0; i < PENDING_PARAMS_MAX && pending_params.pop(change); i++) {
+            const auto& [node_index, param_index, value] = change;
+            if (!isParamValid(node_index, param_index, value)) continue;
+            const auto p_node = all_nodes[node_index];
+            p_node->setParam(param_index, value);
+            if (p_node->getStorageSize() != p_node->storage.size()) {
+                arena.release(p_node->storage.data(), p_node->storage.size_bytes());
+                p_node->storage = arena.createArray<uint64_t>(p_node->getStorageSize(), 0);
+            }
+            fold     = fold || p_node->isTimeInvariant();
+            render   = render || !p_node->getRenderRange().empty();
+            triggers = triggers || p_node->getConfig().type_id == TypeIds::SrTrigger;
+            if (trigger_positions[node_index] != UINT32_MAX) p_node->start(current_tick);
+        }
+
+        if (render) computeUsedChannels();
+        if (triggers) indexExternalTriggers();
+        if (fold) {
+            // Folded values may depend on the changed parameter, fold again from the complete plan
+            execution_plan.assign(full_plan.begin(), full_plan.end());
+            std::ranges::fill(dmx_template, 0);
+            foldConstants();
+        }
+    }
+
+    void Engine::dropParams() noexcept
+    {
+        ParamChange change;
+        while (pending_params.pop(change)) {}
+    }
+
+    std::vector<uint8_t> Engine::exportTree(const bool with_order) const
+    {
+        std::vector<uint8_t> tree = {COMPACT_TREE_VERSION};
+        writeVarint(tree, all_nodes.size());
+        writeVarint(tree, color_links.size());
+        writeVarint(tree, trigger_links.size());
+        tree.push_back(with_order ? CompactTreeFlags::Order : 0);
+
+        for (const auto p_node : all_nodes) {
+            const auto& config = p_node->getConfig();
+            tree.push_back(config.type_id);
+            for (auto i = 0; i < config.params_count; i++) {
+                if (config.params[i].max <= UINT8_MAX)
+                    tree.push_back(static_cast<uint8_t>(std::min<uint16_t>(p_node->getParam(i), UINT8_MAX)));
+                else
+                    writeVarint(tree, p_node->getParam(i));
+            }
+        }
+
+        int64_t    in_node_index = 0;
+        const auto write_link    = [&](const auto* p_link) {
+            writeDelta(tree, p_link->getInput()->index - in_node_index);
+            writeDelta(tree, static_cast<int64_t>(p_link->getOutput()->index) - p_link->getInput()->index);
+            writeVarint(tree, p_link->getOutputIndex() << 8 | p_link->getInputIndex());
+            in_node_index = p_link->getInput()->index;
+        };
+        std::ranges::for_each(color_links, write_link);
+        std::ranges::for_each(trigger_links, write_link);
+
+        if (with_order) {
+            // Nodes in the order of their steps, dead nodes only read from nodes before them and can go last
+            std::vector<bool> listed(all_nodes.size(), false);
+            int64_t           node_index = 0;
+            const auto        write_node = [&](const uint32_t index) {
+                listed[index] = true;
+                writeDelta(tree, index - node_index);
+                node_index = index;
+            };
+            for (const auto& step : full_plan)
+                if (!listed[step.node->index]) write_node(step.node->index);
+            for (const auto p_node : dead_nodes)
+                write_node(p_node->index);
+        }
+        return tree;
+    }
+
+    void Engine::stageBuild(const std::span<const uint8_t> tree, const bool carry_state)
+    {
+        std::unique_ptr<Engine> p_next(retired.exchange(nullptr, std::memory_order_acquire));
+        if (!p_next) p_next = std::make_unique<Engine>();
+        p_next->random_seed = random_seed;
+        p_next->build(tree);
+        p_next->carry_state = carry_state;
+
+        // Tree staged earlier and never swapped in is freed here
+        std::unique_ptr<Engine> p_replaced(staged.exchange(p_next.release(), std::memory_order_acq_rel));
+
+        // Free a tree retired during the build so the ticking thread rarely has to
+        std::unique_ptr<Engine> p_retired(retired.exchange(nullptr, std::memory_order_acquire));
+    }
+
+    bool Engine::isBuildStaged() const noexcept { return staged.load(std::memory_order_relaxed) != nullptr; }
+
+    void Engine::swapStaged() noexcept
+    {
+        const auto p_next = staged.exchange(nullptr, std::memory_order_acquire);
+
+        std::swap(current_tick, p_next->current_tick);
+        std::swap(arena, p_next->arena);
+        std::swap(dmx_data, p_next->dmx_data);
+        std::swap(dmx_previous, p_next->dmx_previous);
+        std::swap(dmx_template, p_next->dmx_template);
+        std::swap(used_channels, p_next->used_channels);
+        std::swap(color_links, p_next->color_links);
+        std::swap(trigger_links, p_next->trigger_links);
+        std::swap(root_nodes, p_next->root_nodes);
+        std::swap(all_nodes, p_next->all_nodes);
+        std::swap(execution_plan, p_next->execution_plan);
+        std::swap(full_plan, p_next->full_plan);
+        std::swap(dead_nodes, p_next->dead_nodes);
+        std::swap(seek_plan, p_next->seek_plan);
+        std::swap(demanded_colors, p_next->demanded_colors);
+        std::swap(selects_inputs, p_next->selects_inputs);
+        std::swap(trigger_nodes, p_next->trigger_nodes);
+        std::swap(trigger_starts, p_next->trigger_starts);
+        std::swap(color_values, p_next->color_values);
+        std::swap(trigger_values, p_next->trigger_values);
+        std::swap(p_random, p_next->p_random);
+        std::swap(trigger_plan, p_next->trigger_plan);
+        std::swap(trigger_plan_starts, p_next->trigger_plan_starts);
+        std::swap(trigger_positions, p_next->trigger_positions);
+        std::swap(step_readers, p_next->step_readers);
+        std::swap(step_readers_starts, p_next->step_readers_starts);
+        std::swap(active_triggers, p_next->active_triggers);
+        std::swap(fired_slots, p_next->fired_slots);
+        std::swap(p_schedule, p_next->p_schedule);
+#ifdef SPARKWEAVER_CORE_PROFILE
+        std::swap(node_profiles, p_next->node_profiles);
+#endif
+        dropParams();
+
+        if (p_next->carry_state) {
+            current_tick = p_next->current_tick;
+            if (p_random != nullptr && p_next->p_random != nullptr) *p_random = *p_next->p_random;
+            for (size_t i = 0; i < std::min(all_nodes.size(), p_next->all_nodes.size()); i++) {
+                if (all_nodes[i]->getConfig().type_id == p_next->all_nodes[i]->getConfig().type_id)
+                    all_nodes[i]->copyState(*p_next->all_nodes[i]);
+            }
+
+            // The new tree was started from tick 0, nodes schedule their events again from the state they took over
+            p_schedule->clear();
+            startTriggers();
+        }
+
+        // Last frame of the previous tree stays the reference for changed channels
+        std::copy_n(p_next->dmx_data.begin(), std::min(dmx_data.size(), p_next->dmx_data.size()), dmx_data.begin());
+
+        // Frame returned by the previous tick is in the previous tree, the worker may not reuse it until the next tick
+        p_retiring = p_next;
+    }
+
+    void Engine::applyPatch(const std::span<const uint8_t> patch)
+    {
+        SafeSpanReader reader(patch);
+        if (!reader.hasByte()) throw InvalidTreeException(0, "Patch is empty");
+        if (reader.readByte() != PATCH_VERSION)
+            throw InvalidTreeException(reader.position(), "Incompatible patch version");
+
+        // Pending changes refer to node indexes before the patch
+        applyParams();
+
+        const auto             previous_nodes         = all_nodes;
+        const auto             previous_color_links   = color_links;
+        const auto             previous_trigger_links = trigger_links;
+        std::vector<PatchUndo> undo;
+        try {
+            while (reader.hasByte()) {
+                switch (const auto command = reader.readByte(); command) {
+                case PatchCommandIds::AddNode: {
+                    if (!reader.hasByte()) throw InvalidTreeException(reader.position(), "Node type missing");
+                    const auto p_config = getNodeConfig(reader.readByte());
+                    if (p_config == nullptr) throw InvalidTreeException(reader.position(), "Unknown node type");
 
-                    // Read params
                     std::array<uint16_t, PARAMS_MAX_COUNT> params = {};
                     for (auto i = 0; i < p_config->params_count; i++) {
                         if (!reader.hasShort()) throw InvalidTreeException(reader.position(), "Missing parameter");
                         params[i] = reader.readShort();
                     }
+                    checkParams(reader.position(), *p_config, params);
+
+                    undo.push_back({PatchUndo::Kind::ADD_NODE, addNode(p_config->type_id, params)});
+                    break;
+                }
+
+                case PatchCommandIds::RemoveNode: {
+                    if (!reader.hasShort()) throw InvalidTreeException(reader.position(), "Node index missing");
+                    const auto index = reader.readShort();
+                    if (index >= all_nodes.size())
+                        throw InvalidTreeException(reader.position(), "Node index out of range");
+                    removeNode(index, undo);
+                    break;
+                }
+
+                case PatchCommandIds::AddColorLink:
+                case PatchCommandIds::AddTriggerLink: {
+                    if (!reader.hasBytes(6)) throw InvalidTreeException(reader.position(), "Link incomplete");
+                    const auto out_node_index = reader.readShort();
+                    const auto in_node_index  = reader.readShort();
+                    const auto out_index      = reader.readByte();
+                    const auto in_index       = reader.readByte();
+                    if (out_node_index >= all_nodes.size() || in_node_index >= all_nodes.size())
+                        throw InvalidTreeException(reader.position(), "Link index out of range");
+
+                    // Constructor validates the link and counts the output, attach checks the input is free
+                    const auto p_out = all_nodes[out_node_index];
+                    const auto p_in  = all_nodes[in_node_index];
+                    if (command == PatchCommandIds::AddColorLink) {
+                        const auto p_link = arena.create<NodeLinkColor>(p_out, p_in, out_index, in_index);
+                        try {
+                            attachLink(p_link, color_links);
+                        } catch (...) {
+                            outputsCountOf(p_link)--;
+                            arena.release(p_link, sizeof(*p_link));
+                            throw;
+                        }
+                        undo.push_back({PatchUndo::Kind::ADD_COLOR_LINK, nullptr, p_link});
+                    } else {
+                        const auto p_link = arena.create<NodeLinkTrigger>(p_out, p_in, out_index, in_index);
+                        try {
+                            attachLink(p_link, trigger_links);
+                        } catch (...) {
+                            outputsCountOf(p_link)--;
+                            arena.release(p_link, sizeof(*p_link));
+                            throw;
+                        }
+                        undo.push_back({PatchUndo::Kind::ADD_TRIGGER_LINK, nullptr, nullptr, p_link});
+                    }
+                    break;
+                }
 
-                    // Make node
-                    const auto p_node = makeNode(p_config->type_id, params);
-                    all_nodes.push_back(p_node);
+                case PatchCommandIds::RemoveColorLink:
+                case PatchCommandIds::RemoveTriggerLink: {
+                    if (!reader.hasBytes(3)) throw InvalidTreeException(reader.position(), "Link incomplete");
+                    const auto in_node_index = reader.readShort();
+                    const auto in_index      = reader.readByte();
+                    if (in_node_index >= all_nodes.size())
+                        throw InvalidTreeException(reader.position(), "Link index out of range");
 
-                    // If node has no outputs add it to root nodes
-                    if (p_config->color_outputs == ColorOutputs::DISABLED &&
-                        p_config->trigger_outputs == TriggerOutputs::DISABLED)
-                        root_nodes.push_back(p_node);
+                    // Inputs take a single link, so the input node and index identify the link
+                    const auto p_in = all_nodes[in_node_index];
+                    if (command == PatchCommandIds::RemoveColorLink) {
+                        if (in_index >= p_in->color_inputs.size() || p_in->color_inputs[in_index] == nullptr)
+                            throw InvalidTreeException(reader.position(), "Color input not connected");
+                        const auto p_link = p_in->color_inputs[in_index];
+                        detachLink(p_link, color_links);
+                        outputsCountOf(p_link)--;
+                        undo.push_back({PatchUndo::Kind::REMOVE_COLOR_LINK, nullptr, p_link});
+                    } else {
+                        if (in_index >= p_in->trigger_inputs.size() || p_in->trigger_inputs[in_index] == nullptr)
+                            throw InvalidTreeException(reader.position(), "Trigger input not connected");
+                        const auto p_link = p_in->trigger_inputs[in_index];
+                        detachLink(p_link, trigger_links);
+                        outputsCountOf(p_link)--;
+                        undo.push_back({PatchUndo::Kind::REMOVE_TRIGGER_LINK, nullptr, nullptr, p_link});
+                    }
+                    break;
+                }
+
+                default:
+                    throw InvalidTreeException(reader.position(), "Unknown command");
                 }
             }
 
+            buildExecutionPlan(reader.position());
         } catch (...) {
-            reset();
+            // The tree before the patch was valid, so its plan builds again
+            undoPatch(undo);
+            // Same links as before, in the order they were exported and bound in
+            color_links   = previous_color_links;
+            trigger_links = previous_trigger_links;
+            buildExecutionPlan(reader.position());
+            finishPatch(previous_nodes);
+            releasePatch(undo, false);
             throw;
         }
+        finishPatch(previous_nodes);
+        releasePatch(undo, true);
     }
 
-    [[nodiscard]] const uint8_t* Engine::tick() noexcept
+    void Engine::releaseNode(Node* p_node)
     {
-        memset(dmx_data, 0, sizeof(dmx_data));
-        for (const auto root_node : root_nodes) {
-            root_node->render(current_tick, dmx_data);
+        arena.release(p_node->color_inputs.data(), p_node->color_inputs_capacity * sizeof(NodeLinkColor*));
+        arena.release(p_node->trigger_inputs.data(), p_node->trigger_inputs_capacity * sizeof(NodeLinkTrigger*));
+        arena.release(p_node->storage.data(), p_node->storage.size_bytes());
+        arena.release(p_node, findNode(p_node->getConfig().type_id)->size);
+    }
+
+    void Engine::releasePatch(const std::vector<PatchUndo>& undo, const bool applied)
+    {
+        // A node or link added and removed by the same patch has both changes but is released by only one of them
+        for (const auto& [kind, p_node, p_color_link, p_trigger_link, index] : undo) {
+            switch (kind) {
+            case PatchUndo::Kind::ADD_NODE:
+                if (!applied) releaseNode(p_node);
+                break;
+            case PatchUndo::Kind::REMOVE_NODE:
+                if (applied) {
+                    p_schedule->remove(p_node);
+                    releaseNode(p_node);
+                }
+                break;
+            case PatchUndo::Kind::ADD_COLOR_LINK:
+                if (!applied) arena.release(p_color_link, sizeof(NodeLinkColor));
+                break;
+            case PatchUndo::Kind::REMOVE_COLOR_LINK:
+                if (applied) arena.release(p_color_link, sizeof(NodeLinkColor));
+                break;
+            case PatchUndo::Kind::ADD_TRIGGER_LINK:
+                if (!applied) arena.release(p_trigger_link, sizeof(NodeLinkTrigger));
+                break;
+            case PatchUndo::Kind::REMOVE_TRIGGER_LINK:
+                if (applied) arena.release(p_trigger_link, sizeof(NodeLinkTrigger));
+                break;
+            }
+        }
+    }
+
+    [[nodiscard]] const uint8_t* Engine::tick() noexcept { return tickUniverses().data(); }
+
+    void Engine::execute() noexcept
+    {
+        // A retired tree the worker did not take back is dropped, the swap never waits for it
+        if (p_retiring != nullptr) {
+            delete retired.exchange(p_retiring, std::memory_order_acq_rel);
+            p_retiring = nullptr;
+        }
+        if (staged.load(std::memory_order_relaxed) != nullptr) swapStaged();
+        applyParams();
+
+        // At most one queue length, triggers pushed while draining wait for the next tick
+        uint8_t trigger_id;
+        for (size_t i = 0; i < EXTERNAL_TRIGGERS_MAX && external_triggers.pop(trigger_id); i++) {
+            for (auto j = trigger_starts[trigger_id]; j < trigger_starts[trigger_id + 1]; j++) {
+                trigger_nodes[j]->trigger(current_tick);
+                activateTrigger(trigger_nodes[j]);
+            }
+        }
+        evaluateTriggers();
+
+        std::swap(dmx_data, dmx_previous);
+        std::ranges::copy(dmx_template, dmx_data.begin());
+        if (selects_inputs) demandColors();
+        for (const auto& [node, slot, output_index, kind] : execution_plan) {
+            if (selects_inputs && kind == ExecutionStep::Kind::COLOR && !demanded_colors[slot]) continue;
+#ifdef SPARKWEAVER_CORE_PROFILE
+            const auto start = std::chrono::steady_clock::now();
+#endif
+            switch (kind) {
+            case ExecutionStep::Kind::COLOR:
+                color_values[slot] = node->getColor(current_tick, output_index);
+                break;
+            case ExecutionStep::Kind::RENDER:
+                node->render(current_tick, dmx_data.data());
+                break;
+            case ExecutionStep::Kind::TRIGGER:
+                break; // Kept out of the plan by foldConstants
+            }
+#ifdef SPARKWEAVER_CORE_PROFILE
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            auto&      profile = node_profiles[node->index];
+            profile.evaluations++;
+            profile.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+#endif
         }
         current_tick++;
+    }
+
+    [[nodiscard]] std::span<const uint8_t> Engine::tickUniverses() noexcept
+    {
+        execute();
         return dmx_data;
     }
 
-    std::vector<uint8_t> Engine::listExternalTriggers() const noexcept
+    size_t
+    Engine::tickMany(const size_t count, const std::span<uint8_t> frames, const size_t first, size_t last) noexcept
     {
-        std::set<uint8_t> ids;
-        for (const auto& node : all_nodes) {
-            if (node->getConfig().type_id == TypeIds::SrTrigger) {
-                ids.insert(node->getParam(0));
-            }
+        last = std::min(last, dmx_data.size());
+        if (first >= last) return 0;
+
+        const auto frame_size = last - first;
+        const auto ticks      = std::min(count, frames.size() / frame_size);
+        for (size_t i = 0; i < ticks; i++) {
+            execute();
+            std::copy(dmx_data.begin() + first, dmx_data.begin() + last, frames.begin() + i * frame_size);
+        }
+        return ticks;
+    }
+
+    size_t Engine::renderAhead(FrameRing& ring, const size_t first) noexcept
+    {
+        size_t ticks = 0;
+        for (auto slot = ring.writeSlot(); !slot.empty(); slot = ring.writeSlot()) {
+            execute();
+            // Universes may change with a staged tree, a slot keeps its size
+            const auto start = std::min(first, dmx_data.size());
+            const auto size  = std::min(slot.size(), dmx_data.size() - start);
+            std::copy_n(dmx_data.begin() + start, size, slot.begin());
+            std::fill(slot.begin() + size, slot.end(), 0);
+            ring.commitWrite();
+            ticks++;
         }
-        return {ids.begin(), ids.end()};
+        return ticks;
     }
 
-    void Engine::triggerExternalTrigger(const uint8_t id) const noexcept
+    void Engine::seek(const uint32_t tick) noexcept
     {
-        for (const auto& node : all_nodes) {
-            if (node->getConfig().type_id == TypeIds::SrTrigger) {
-                if (node->getParam(0) == id) {
-                    node->trigger(current_tick);
+        applyParams();
+        if (tick < current_tick) restartState();
+
+        // Ticks without events change no state, the clock jumps from one event to the next
+        while (p_schedule->nextTick() < tick) {
+            current_tick = std::max(current_tick, p_schedule->nextTick());
+            evaluateTriggers();
+            if (!fired_slots.empty()) {
+                if (selects_inputs) demandColors();
+                for (const auto& step : seek_plan) {
+                    if (!selects_inputs || demanded_colors[step.slot]) step.node->skip(current_tick);
                 }
             }
+            current_tick++;
+        }
+        current_tick = tick;
+    }
+
+    uint32_t Engine::getTick() const noexcept { return current_tick; }
+
+    void Engine::restartState() noexcept
+    {
+        p_schedule->clear();
+        for (const auto p_node : all_nodes)
+            p_node->resetState();
+        if (p_random != nullptr) *p_random = RandomGenerator(random_seed);
+        current_tick = 0;
+        startTriggers();
+    }
+
+    std::vector<uint8_t> Engine::saveState() const
+    {
+        std::vector<uint8_t> state = {STATE_VERSION};
+        writeVarint(state, all_nodes.size());
+        writeVarint(state, current_tick);
+        if (p_random != nullptr) {
+            for (const auto word : p_random->getState())
+                writeVarint(state, word);
+        }
+
+        // Pending events relative to the tick, events of nodes a patch removed or left dead are dropped
+        std::vector<TriggerSchedule::Event> events;
+        for (const auto& event : p_schedule->getEvents()) {
+            const auto index = event.p_node->index;
+            if (TriggerSchedule::isPending(event) && index < all_nodes.size() && all_nodes[index] == event.p_node &&
+                trigger_positions[index] != UINT32_MAX)
+                events.push_back(event);
+        }
+        std::ranges::sort(events, {}, [](const TriggerSchedule::Event& event) {
+            return std::pair(event.tick, event.p_node->index);
+        });
+        writeVarint(state, events.size());
+        for (const auto& [tick, p_node] : events) {
+            writeVarint(state, p_node->index);
+            writeVarint(state, std::max(tick, current_tick) - current_tick);
+        }
+
+        for (const auto p_node : all_nodes) {
+            state.push_back(p_node->getConfig().type_id);
+            p_node->saveState(state);
+        }
+        return state;
+    }
+
+    void Engine::restoreState(const std::span<const uint8_t> state)
+    {
+        // Nodes are overwritten one by one, on an error the snapshot of the current state puts them back
+        const auto previous = saveState();
+        try {
+            readState(state);
+        } catch (...) {
+            readState(previous);
+            throw;
+        }
+    }
+
+    void Engine::readState(const std::span<const uint8_t> state)
+    {
+        SafeSpanReader reader(state);
+        if (!reader.hasByte()) throw InvalidTreeException(0, "State is empty");
+        if (reader.readByte() != STATE_VERSION)
+            throw InvalidTreeException(reader.position(), "Incompatible state version");
+        if (!reader.hasVarint()) throw InvalidTreeException(reader.position(), "Missing nodes count");
+        if (reader.readVarint() != all_nodes.size())
+            throw InvalidTreeException(reader.position(), "State is from a tree with a different number of nodes");
+        if (!reader.hasVarint()) throw InvalidTreeException(reader.position(), "Missing tick");
+        const auto tick = reader.readVarint();
+
+        if (p_random != nullptr) {
+            std::array<uint32_t, 4> random_state{};
+            for (auto& word : random_state) {
+                if (!reader.hasVarint()) throw InvalidTreeException(reader.position(), "Missing random state");
+                word = reader.readVarint();
+            }
+            if (!p_random->setState(random_state))
+                throw InvalidTreeException(reader.position(), "Invalid random state");
+        }
+
+        // Every event takes at least two bytes, so the count cannot reserve more than the state holds
+        if (!reader.hasVarint()) throw InvalidTreeException(reader.position(), "Missing events count");
+        const auto events_count = reader.readVarint();
+        if (2ull * events_count > reader.remaining())
+            throw InvalidTreeException(reader.position(), "Events incomplete");
+        std::vector<TriggerSchedule::Event> events;
+        events.reserve(events_count);
+        for (uint32_t i = 0; i < events_count; i++) {
+            if (!reader.hasVarint()) throw InvalidTreeException(reader.position(), "Event incomplete");
+            const auto index = reader.readVarint();
+            if (!reader.hasVarint()) throw InvalidTreeException(reader.position(), "Event incomplete");
+            const auto delay = reader.readVarint();
+            if (index >= all_nodes.size() || trigger_positions[index] == UINT32_MAX || delay > UINT32_MAX - tick)
+                throw InvalidTreeException(reader.position(), "Invalid event");
+            events.push_back({tick + delay, all_nodes[index]});
+        }
+
+        for (const auto p_node : all_nodes) {
+            if (!reader.hasByte()) throw InvalidTreeException(reader.position(), "Node state missing");
+            if (reader.readByte() != p_node->getConfig().type_id)
+                throw InvalidTreeException(reader.position(), "State is from a tree with different node types");
+            if (!p_node->loadState(reader)) throw InvalidTreeException(reader.position(), "Invalid node state");
+        }
+        if (reader.hasByte()) throw InvalidTreeException(reader.position(), "Unexpected data after state");
+        p_schedule->clear();
+        for (const auto& [event_tick, p_node] : events)
+            p_schedule->push(event_tick, p_node);
+        current_tick = tick;
+    }
+
+    size_t Engine::getUniverseCount() const noexcept { return dmx_data.size() / DMX_PACKET_SIZE; }
+
+    size_t Engine::getDeadNodeCount() const noexcept { return dead_nodes.size(); }
+
+    ChannelRange Engine::getUsedChannels(const size_t universe) const noexcept
+    {
+        if (universe >= used_channels.size()) return {};
+        return used_channels[universe];
+    }
+
+    ChannelRange Engine::getChangedChannels(const size_t universe) const noexcept
+    {
+        if (universe >= getUniverseCount()) return {};
+        const auto current  = dmx_data.data() + universe * DMX_PACKET_SIZE;
+        const auto previous = dmx_previous.data() + universe * DMX_PACKET_SIZE;
+
+        size_t start = 0;
+        while (start < DMX_PACKET_SIZE && current[start] == previous[start])
+            start++;
+        if (start == DMX_PACKET_SIZE) return {};
+
+        size_t end = DMX_PACKET_SIZE;
+        while (current[end - 1] == previous[end - 1])
+            end--;
+        return {start, end};
+    }
+
+    bool Engine::isParamValid(const size_t node_index, const uint8_t param_index, const uint16_t value) const noexcept
+    {
+        if (node_index >= all_nodes.size()) return false;
+        const auto& config = all_nodes[node_index]->getConfig();
+        if (param_index >= config.params_count) return false;
+        if (value < config.params[param_index].min || value > config.params[param_index].max) return false;
+        // Moving to a new universe would need a larger DMX buffer
+        return config.type_id != TypeIds::DsDmxRgbUniverse || param_index != 1 || value < getUniverseCount();
+    }
+
+    bool Engine::setParam(const size_t node_index, const uint8_t param_index, const uint16_t value) noexcept
+    {
+        if (node_index > UINT32_MAX) return false;
+        return pending_params.push({static_cast<uint32_t>(node_index), param_index, value});
+    }
+
+    void Engine::setSeed(const uint64_t seed) noexcept
+    {
+        random_seed = seed;
+        if (p_random != nullptr) *p_random = RandomGenerator(seed);
+    }
+
+    std::vector<NodeProfile> Engine::getNodeProfiles() const noexcept
+    {
+#ifdef SPARKWEAVER_CORE_PROFILE
+        return node_profiles;
+#else
+        return {};
+#endif
+    }
+
+    void Engine::resetNodeProfiles() noexcept
+    {
+#ifdef SPARKWEAVER_CORE_PROFILE
+        for (auto& profile : node_profiles) {
+            profile.evaluations = 0;
+            profile.nanoseconds = 0;
         }
+#endif
     }
+
+    std::vector<uint8_t> Engine::listExternalTriggers() const noexcept
+    {
+        std::vector<uint8_t> ids;
+        for (size_t id = 0; id < trigger_starts.size() - 1; id++)
+            if (trigger_starts[id] != trigger_starts[id + 1]) ids.push_back(id);
+        return ids;
+    }
+
+    bool Engine::triggerExternalTrigger(const uint8_t id) noexcept { return external_triggers.push(id); }
 }
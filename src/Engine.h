@@ -1,9 +1,15 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <cstdint>
+#include <memory>
+#include <random>
+#include <span>
 #include <unordered_map>
 
 #include "../src/nodes/DsDmxRgb.h"
+#include "../src/nodes/DsDmxRgbUniverse.h"
 #include "../src/nodes/FxBreathe.h"
 #include "../src/nodes/FxPulse.h"
 #include "../src/nodes/FxStrobe.h"
@@ -20,26 +26,33 @@
 #include "../src/nodes/TrDelay.h"
 #include "../src/nodes/TrRandom.h"
 #include "../src/nodes/TrSequence.h"
+#include "../src/utils/Arena.h"
+#include "../src/utils/FrameRing.h"
+#include "../src/utils/MpscQueue.h"
+#include "../src/utils/SafeSpanReader.h"
+#include "../src/utils/TriggerSchedule.h"
 
 namespace SparkWeaverCore {
     using NodeParams = const std::array<uint16_t, PARAMS_MAX_COUNT>&;
-    using NodeCtor   = Node* (*)(NodeParams);
+    using NodeCtor   = Node* (*)(Arena&, NodeParams);
 
     template <typename T>
-    Node* createNode(NodeParams p)
+    Node* createNode(Arena& arena, NodeParams p)
     {
-        return new T(p);
+        return arena.create<T>(p);
     }
 
     struct NodeInfo {
         const NodeConfig* config;
         const NodeCtor    ctor;
+        const size_t      size; // Bytes taken in the arena
 
         NodeInfo() = delete;
 
-        NodeInfo(const NodeConfig* config, const NodeCtor ctor)
+        NodeInfo(const NodeConfig* config, const NodeCtor ctor, const size_t size)
             : config(config)
             , ctor(ctor)
+            , size(size)
         {
         }
     };
@@ -47,7 +60,7 @@ namespace SparkWeaverCore {
     template <typename T>
     std::pair<uint8_t, NodeInfo> registerNode()
     {
-        return {T::config.type_id, NodeInfo(&T::config, createNode<T>)};
+        return {T::config.type_id, NodeInfo(&T::config, createNode<T>, sizeof(T))};
     }
 
     class InvalidTreeException final : public std::exception {
@@ -67,6 +80,66 @@ namespace SparkWeaverCore {
         [[nodiscard]] const char* what() const noexcept override { return message.c_str(); }
     };
 
+    /**
+     * @struct ExecutionStep
+     * @brief Single node evaluation in the execution plan, writes one link value or renders a root node.
+     */
+    struct ExecutionStep {
+        enum class Kind : uint8_t {
+            COLOR,
+            TRIGGER,
+            RENDER,
+        };
+
+        Node*    node;
+        uint32_t slot;
+        uint8_t  output_index;
+        Kind     kind;
+    };
+
+    /**
+     * @struct ParamChange
+     * @brief Parameter value waiting for the next tick.
+     */
+    struct ParamChange {
+        uint32_t node_index;
+        uint8_t  param_index;
+        uint16_t value;
+    };
+
+    /**
+     * @struct PatchUndo
+     * @brief Reverts a single change made by \c Engine::applyPatch.
+     */
+    struct PatchUndo {
+        enum class Kind : uint8_t {
+            ADD_NODE,
+            REMOVE_NODE,
+            ADD_COLOR_LINK,
+            REMOVE_COLOR_LINK,
+            ADD_TRIGGER_LINK,
+            REMOVE_TRIGGER_LINK,
+        };
+
+        Kind             kind;
+        Node*            node         = nullptr;
+        NodeLinkColor*   color_link   = nullptr;
+        NodeLinkTrigger* trigger_link = nullptr;
+        uint32_t         index        = 0; // Position of a removed node
+    };
+
+    /**
+     * @struct NodeProfile
+     * @brief Evaluations of a single node and time spent in them, recorded only when built with
+     * \c SPARKWEAVER_CORE_PROFILE.
+     */
+    struct NodeProfile {
+        uint32_t index;       // Position in the tree
+        uint8_t  type_id;
+        uint64_t evaluations; // Calls to getColor, getTrigger and render
+        uint64_t nanoseconds;
+    };
+
     /**
      * @class Engine
      * @brief Builds and runs the node tree.
@@ -74,6 +147,7 @@ namespace SparkWeaverCore {
     class Engine {
         static inline const std::unordered_map<uint8_t, NodeInfo> node_registry = {
             registerNode<DsDmxRgb>(),
+            registerNode<DsDmxRgbUniverse>(),
             registerNode<FxBreathe>(),
             registerNode<FxPulse>(),
             registerNode<FxStrobe>(),
@@ -91,18 +165,259 @@ namespace SparkWeaverCore {
             registerNode<TrRandom>(),
             registerNode<TrSequence>()};
 
-        uint32_t                      current_tick              = 0;
-        uint8_t                       dmx_data[DMX_PACKET_SIZE] = {};
+        static constexpr size_t PENDING_PARAMS_MAX    = 64;
+        static constexpr size_t EXTERNAL_TRIGGERS_MAX = 64;
+
+        uint32_t                      current_tick = 0;
+        Arena                         arena{};
+        std::vector<uint8_t>          dmx_data     = std::vector<uint8_t>(DMX_PACKET_SIZE);
+        std::vector<uint8_t>          dmx_previous = std::vector<uint8_t>(DMX_PACKET_SIZE);
+        std::vector<uint8_t>          dmx_template = std::vector<uint8_t>(DMX_PACKET_SIZE);
+        std::vector<ChannelRange>     used_channels{};
         std::vector<NodeLinkColor*>   color_links{};
         std::vector<NodeLinkTrigger*> trigger_links{};
         std::vector<Node*>            root_nodes{};
         std::vector<Node*>            all_nodes{};
+        std::vector<ExecutionStep>    execution_plan{};
+        std::vector<ExecutionStep>    full_plan{};  // Execution plan before constant folding, trigger steps included
+        std::vector<Node*>            dead_nodes{}; // Not reaching a destination node, in evaluation order
+        std::vector<ExecutionStep>    seek_plan{};  // Color steps that advance state, kept with the plan
+        std::span<Color>              color_values{};
+        std::span<bool>               trigger_values{};
+        std::vector<uint8_t>          demanded_colors{};      // Color slots read in the current tick, by demandColors
+        bool                          selects_inputs = false; // Plan has a node that evaluates one color input
+        uint64_t                      random_seed    = std::random_device{}();
+        RandomGenerator*              p_random       = nullptr; // In the arena so it moves with the nodes on a swap
+
+        MpscQueue<ParamChange, PENDING_PARAMS_MAX> pending_params{}; // Checked when applied, the tree may change first
+
+        // External trigger nodes grouped by id, nodes of id N are from trigger_starts[N] to trigger_starts[N + 1]
+        std::vector<Node*>                        trigger_nodes{};
+        std::array<uint32_t, 256 + 1>             trigger_starts{};
+        MpscQueue<uint8_t, EXTERNAL_TRIGGERS_MAX> external_triggers{}; // Stays with this engine when trees are swapped
+
+        // Trigger nodes run only at scheduled ticks and when a trigger input fires, their steps are grouped by node in
+        // evaluation order, steps at position N are from trigger_plan_starts[N] to trigger_plan_starts[N + 1]
+        std::vector<ExecutionStep>       trigger_plan{};
+        std::vector<uint32_t>            trigger_plan_starts{};
+        std::vector<uint32_t>            trigger_positions{};  // Position in the trigger plan by node index
+        std::vector<uint32_t>            step_readers{};       // Positions of trigger nodes reading each trigger step
+        std::vector<uint32_t>            step_readers_starts{};
+        std::vector<uint32_t>            active_triggers{};    // Heap of positions to evaluate in the current tick
+        std::vector<uint32_t>            fired_slots{};        // Trigger values set to true by the last evaluation
+        std::unique_ptr<TriggerSchedule> p_schedule = std::make_unique<TriggerSchedule>(); // Moves with the nodes
+#ifdef SPARKWEAVER_CORE_PROFILE
+        std::vector<NodeProfile> node_profiles{};
+#endif
+
+        // Background builds, the ticking thread only swaps staged in and leaves the previous tree in retired
+        std::atomic<Engine*> staged{nullptr};
+        std::atomic<Engine*> retired{nullptr};
+        Engine*              p_retiring  = nullptr; // Holds the frame of the tick before the swap until the next tick
+        bool                 carry_state = false;   // Set on a staged engine
 
+        static const NodeInfo*   findNode(uint8_t type_id) noexcept;
         static const NodeConfig* getNodeConfig(uint8_t type_id) noexcept;
-        static Node*             makeNode(uint8_t type_id, NodeParams params) noexcept;
 
+        /**
+         * @brief Create a node in the arena and append it to the tree, nodes without outputs are also added to roots.
+         * @return Node or nullptr if the type is unknown
+         */
+        Node* addNode(uint8_t type_id, NodeParams params);
+
+        /**
+         * @brief Read nodes and links of a version 3 tree.
+         * @throws InvalidTreeException If the tree contains errors
+         * @throws InvalidLinkException If the tree has invalid links
+         */
+        void parseTree(SafeSpanReader& reader);
+
+        /**
+         * @brief Read nodes, links and the optional evaluation order of a compact version 4 or 5 tree.
+         * @param order Receives the evaluation order, left empty if the tree has none
+         * @param version Tree version, version 4 stores the delay of \c TrDelay in one byte
+         * @throws InvalidTreeException If the tree contains errors
+         * @throws InvalidLinkException If the tree has invalid links
+         */
+        void parseCompactTree(SafeSpanReader& reader, std::vector<uint32_t>& order, uint8_t version);
+
+        /**
+         * @brief Clear the tree, nodes and links are released together with the arena in constant time.
+         */
         void reset() noexcept;
 
+        /**
+         * @brief Allocate node input lists in the arena and register every link in its input node.
+         * @throws InvalidLinkException If an input is connected more than once
+         */
+        void connectLinks();
+
+        /**
+         * @brief Evaluate the trigger nodes due in the current tick, run the execution plan into \c dmx_data and
+         * advance the clock.
+         */
+        void execute() noexcept;
+
+        /**
+         * @brief Group the trigger steps of the full plan by node and find the trigger nodes reading every step.
+         */
+        void buildTriggerPlan();
+
+        /**
+         * @brief Let every trigger node in the plan schedule its first evaluation from the current tick.
+         */
+        void startTriggers() noexcept;
+
+        /**
+         * @brief Queue a trigger node for evaluation in the current tick.
+         * @return False if the node is not evaluated by the current tree, for example after a patch removed it
+         */
+        bool activateTrigger(const Node* p_node) noexcept;
+
+        /**
+         * @brief Evaluate trigger nodes with an event due or a trigger input firing in the current tick, all other
+         * trigger values are false.
+         */
+        void evaluateTriggers() noexcept;
+
+        /**
+         * @brief Sort nodes so that every node follows the nodes it reads from.
+         * @param pos Tree position reported in exceptions
+         * @param order Receives all nodes in evaluation order
+         * @throws InvalidTreeException If the tree contains a cycle, reported with the nodes in it, or an unconnected
+         * input
+         */
+        void searchOrder(size_t pos, std::vector<Node*>& order) const;
+
+        /**
+         * @brief Sort nodes in dependency order and bind every link to its value table slot, nodes whose outputs never
+         * reach a destination node are kept in \c dead_nodes instead of the plan.
+         * @param pos Tree position reported in exceptions
+         * @param evaluation_order Node indexes in evaluation order stored in the tree, searched if empty
+         * @throws InvalidTreeException If the tree contains a cycle or an unconnected input, or the given order is not
+         * valid
+         */
+        void buildExecutionPlan(size_t pos, std::span<const uint32_t> evaluation_order = {});
+
+        /**
+         * @brief Evaluate time invariant nodes whose inputs are all constant once and remove them from the plan.
+         * @note Destination nodes fed only by constants are rendered into \c dmx_template which every tick starts from,
+         * unless an earlier destination node that stays in the plan writes the same channels.
+         */
+        void foldConstants() noexcept;
+
+        /**
+         * @brief Mark the color slots read in the current tick, inputs a node does not select are left out together
+         * with every node only they read.
+         * @note Calls \c selectInput of the nodes that are read, only needed if \c selects_inputs is set.
+         */
+        void demandColors() noexcept;
+
+        /**
+         * @brief Get the number of universes addressed by destination nodes.
+         * @return One more than the highest universe used, at least 1
+         */
+        [[nodiscard]] size_t countUniverses() const noexcept;
+
+        /**
+         * @brief Allocate zeroed universes and profiles and finish the plan after the execution plan is built.
+         */
+        void finishBuild();
+
+        /**
+         * @brief Finish the plan after a patch, frames are kept and profiles follow their nodes.
+         * @param previous_nodes Nodes in tree order before the patch
+         */
+        void finishPatch(std::span<Node* const> previous_nodes);
+
+        /**
+         * @brief Compute used channels, group trigger steps, fold constants into a zeroed template and start trigger
+         * nodes.
+         */
+        void finishPlan();
+
+        /**
+         * @brief Register a link in its input node and the link list, grows the input list when needed.
+         * @attention Output count of the output node is not changed.
+         * @throws InvalidLinkException If the input is already connected
+         */
+        template <typename Link>
+        void attachLink(Link* p_link, std::vector<Link*>& links);
+
+        /**
+         * @brief Remove a link from its input node and the link list, trailing empty inputs are dropped.
+         * @attention Output count of the output node is not changed.
+         */
+        template <typename Link>
+        void detachLink(Link* p_link, std::vector<Link*>& links) noexcept;
+
+        /**
+         * @brief Remove a node and every link from or to it.
+         */
+        void removeNode(size_t index, std::vector<PatchUndo>& undo);
+
+        /**
+         * @brief Revert changes of a patch in reverse order.
+         */
+        void undoPatch(const std::vector<PatchUndo>& undo) noexcept;
+
+        /**
+         * @brief Give the memory of a node and its input lists back to the arena.
+         */
+        void releaseNode(Node* p_node);
+
+        /**
+         * @brief Give back the memory of nodes and links a patch removed, or of those a rejected patch added.
+         * @param applied Whether the patch was applied or rolled back
+         */
+        void releasePatch(const std::vector<PatchUndo>& undo, bool applied);
+
+        /**
+         * @brief Replace the tree with the staged one, the previous tree is moved to the staged engine and retired at
+         * the next tick.
+         */
+        void swapStaged() noexcept;
+
+        /**
+         * @brief Compute \c used_channels from the render ranges of destination nodes.
+         */
+        void computeUsedChannels() noexcept;
+
+        /**
+         * @brief Group external trigger nodes by id, done after every build and patch and when an id changes.
+         * @note Does not allocate if the number of external trigger nodes is unchanged.
+         */
+        void indexExternalTriggers();
+
+        /**
+         * @brief Check a parameter change against the current tree.
+         * @return False if the node, parameter or value is invalid or the universe is not rendered by the tree
+         */
+        [[nodiscard]] bool isParamValid(size_t node_index, uint8_t param_index, uint16_t value) const noexcept;
+
+        /**
+         * @brief Apply queued parameter changes together before a tick, folds constants again if a time invariant
+         * node changed. Invalid changes are dropped.
+         * @note Allocates in the arena only when the storage size of a node changes, such as the length of a delay.
+         */
+        void applyParams() noexcept;
+
+        /**
+         * @brief Drop queued parameter changes, they refer to a tree that is replaced.
+         */
+        void dropParams() noexcept;
+
+        /**
+         * @brief Put every node and the random generator back to their state after the build and the clock to 0.
+         */
+        void restartState() noexcept;
+
+        /**
+         * @brief Read a snapshot into the clock, the random generator and the nodes.
+         * @throws InvalidTreeException If the snapshot is invalid, the state may be partly read
+         */
+        void readState(std::span<const uint8_t> state);
+
     public:
         Engine() = default;
 
@@ -116,29 +431,211 @@ namespace SparkWeaverCore {
 
         /**
          * @brief Resets the node tree and tries to parse a new tree.
-         * @param tree Serialized tree bytes
+         * @param tree Serialized tree bytes, read in place and not kept after the build (for example a \c MappedFile)
          * @throws InvalidTreeException If the tree contains errors
          * @throws InvalidLinkException If the tree has invalid links
          */
-        void build(const std::vector<uint8_t>& tree);
+        void build(std::span<const uint8_t> tree);
+
+        /**
+         * @brief Serialize the current tree in the compact version 5 format, building a version 3 tree and exporting it
+         * converts the tree.
+         * @note Parameters changed by \c setParam and patches are included, node state is not. Parameters limited to a
+         * byte are stored in a byte, larger values are clamped.
+         * @param with_order Store the evaluation order so the next build skips sorting
+         * @return Serialized tree bytes
+         */
+        [[nodiscard]] std::vector<uint8_t> exportTree(bool with_order = true) const;
+
+        /**
+         * @brief Build a tree without touching the current one, it replaces the current tree at the start of the next
+         * tick after the build.
+         * @note Meant for a worker thread while another thread keeps ticking, which never waits for the build. Must
+         * not be called from two threads at once. A tree staged but not yet swapped in is replaced. Memory of the tree
+         * replaced by the previous swap is reused once a tick has passed after it, the frame returned by the tick
+         * before the swap is not touched until the tick after it, if no build reused it by then the ticking thread
+         * frees it. Pending parameter changes of the current tree are dropped by the swap.
+         * @param tree Serialized tree bytes
+         * @param carry_state Continue from the current tick and take over the state of nodes that have the same type
+         * and position in both trees
+         * @throws InvalidTreeException If the tree contains errors, the current tree keeps running
+         * @throws InvalidLinkException If the tree has invalid links, the current tree keeps running
+         */
+        void stageBuild(std::span<const uint8_t> tree, bool carry_state = false);
+
+        /**
+         * @brief Check if a tree built by \c stageBuild is still waiting for the next tick.
+         * @return True until the staged tree is swapped in
+         */
+        [[nodiscard]] bool isBuildStaged() const noexcept;
+
+        /**
+         * @brief Add and remove nodes and links of the current tree in place.
+         * @note Nodes not touched by the patch keep their state and the clock is not reset. Node indexes after a
+         * removed node shift down by one, added nodes are appended to the end. Commands are applied in order, so
+         * indexes refer to the tree as changed by the previous commands. Pending parameter changes are applied first.
+         * Memory of removed nodes and links is reused by later patches. Parsing, validation and allocation scale with
+         * the patch, but the evaluation order, live nodes, value slots, trigger plan and folded constants are
+         * computed again for the whole tree, since one removed link can leave any part of it dead or constant. Frames
+         * of the previous tick are kept, so changed channels of the next tick show only what the patch changed. A
+         * patch that adds a universe reallocates the frames and the pointer returned by the previous \c tick is no
+         * longer valid.
+         * @param patch Serialized patch bytes
+         * @throws InvalidTreeException If the patch contains errors or the patched tree is invalid, the tree is left
+         * unchanged
+         * @throws InvalidLinkException If the patch has invalid links, the tree is left unchanged
+         */
+        void applyPatch(std::span<const uint8_t> patch);
 
         /**
-         * @brief Increment global clock and execute all nodes.
-         * @return Pointer to 513 bytes long DMX data output, byte number corresponds to DMX address, 0 is unused
+         * @brief Increment global clock and execute all nodes once in dependency order.
+         * @return Pointer to 513 bytes long DMX data output of universe 0, byte number corresponds to DMX address, 0 is
+         * unused
          */
         [[nodiscard]] const uint8_t* tick() noexcept;
 
+        /**
+         * @brief Increment global clock and execute all nodes once, rendering every universe.
+         * @return Span over \c getUniverseCount() consecutive 513 bytes long DMX universes, universe N starts at byte
+         * N * 513 and the first byte of each universe is unused
+         */
+        [[nodiscard]] std::span<const uint8_t> tickUniverses() noexcept;
+
+        /**
+         * @brief Render consecutive ticks into a caller provided buffer, returns after all ticks are done.
+         * @param count Number of ticks to render
+         * @param frames Buffer receiving the frames back to back, each \c last - \c first bytes long
+         * @param first First byte of the \c tickUniverses span to copy from every frame
+         * @param last One past the last byte to copy, clamped to the end of the last universe
+         * @return Number of ticks rendered, less than \c count if \c frames cannot hold all of them
+         */
+        size_t tickMany(size_t count, std::span<uint8_t> frames, size_t first = 0, size_t last = SIZE_MAX) noexcept;
+
+        /**
+         * @brief Render ticks into every free slot of a ring while another thread sends frames from it.
+         * @note Frames are rendered ahead of time, so external triggers and parameter changes show up to one ring
+         * length later than with \c tick.
+         * @param ring Ring filled from the thread that ticks
+         * @param first First byte of the \c tickUniverses span to copy into a slot, bytes past the last universe are
+         * zero
+         * @return Number of ticks rendered, 0 if the ring is full
+         */
+        size_t renderAhead(FrameRing& ring, size_t first = 0) noexcept;
+
+        /**
+         * @brief Move the clock to any tick without rendering the ticks in between, for previewing a show.
+         * @note Nodes whose output depends only on the tick are not evaluated at all. The clock jumps from one
+         * scheduled trigger event to the next, nodes with state run their trigger logic only on ticks where a trigger
+         * fires, without color math or DMX writes, so with a seed set by \c setSeed the next tick renders the same
+         * frame as ticking to it. Seeking back replays state from tick 0. Pending parameter
+         * changes are applied first, external triggers and a staged tree wait for the next tick. Changed channels of
+         * the next tick are relative to the last frame rendered before the seek.
+         * @param tick Tick rendered by the next \c tick
+         */
+        void seek(uint32_t tick) noexcept;
+
+        /**
+         * @brief Get the tick rendered by the next \c tick.
+         */
+        [[nodiscard]] uint32_t getTick() const noexcept;
+
+        /**
+         * @brief Save the clock, the random generator, pending trigger events and the state of every node, for example
+         * to resume a show after a restart.
+         * @note The tree and its parameters are not included, see \c exportTree. Pending parameter changes, external
+         * triggers and a staged tree are not included either.
+         * @return Snapshot bytes starting with \c STATE_VERSION
+         */
+        [[nodiscard]] std::vector<uint8_t> saveState() const;
+
+        /**
+         * @brief Continue from a snapshot taken by \c saveState of the same tree, in time proportional to the snapshot
+         * size.
+         * @note Must be called from the thread that ticks. Changed channels of the next tick are relative to the last
+         * frame rendered before the restore.
+         * @param state Snapshot bytes
+         * @throws InvalidTreeException If the snapshot is invalid or was taken from a tree with other nodes, the state
+         * is left unchanged
+         */
+        void restoreState(std::span<const uint8_t> state);
+
+        /**
+         * @brief Get the number of universes rendered by the current tree.
+         * @return One more than the highest universe used by a destination node, at least 1
+         */
+        [[nodiscard]] size_t getUniverseCount() const noexcept;
+
+        /**
+         * @brief Get the number of nodes left out of evaluation because none of their outputs reach a destination node.
+         * @note Dead nodes keep their position in the tree and their state does not advance. A patch linking one to a
+         * destination node brings it back into evaluation.
+         * @return Dead nodes in the current tree
+         */
+        [[nodiscard]] size_t getDeadNodeCount() const noexcept;
+
+        /**
+         * @brief Get the channels written by destination nodes of the current tree.
+         * @note Sending a packet of \c end bytes, start code included, is enough to update all fixtures.
+         * @param universe Universe number
+         * @return DMX addresses from the lowest to one past the highest used address, empty if the universe is unused
+         */
+        [[nodiscard]] ChannelRange getUsedChannels(size_t universe) const noexcept;
+
+        /**
+         * @brief Get the channels that changed between the last two ticks.
+         * @note Pointer returned by the previous \c tick still holds the previous frame until the next tick.
+         * @param universe Universe number
+         * @return DMX addresses from the first to one past the last changed address, empty if the frame did not change
+         */
+        [[nodiscard]] ChannelRange getChangedChannels(size_t universe) const noexcept;
+
+        /**
+         * @brief Change a node parameter without rebuilding the tree, node state and the current tick are kept.
+         * @note Safe to call from any thread, for example a UI thread while another thread ticks. Changes are queued
+         * and all changes made between two ticks are applied together at the start of the next tick, or of the next
+         * seek or patch. They are checked against the tree when applied, a change with an invalid node, parameter or
+         * value, or one moving a node to a universe the tree does not render, is dropped then.
+         * @param node_index Position of the node in the tree
+         * @param param_index Parameter index
+         * @param value New value, must be within the parameter limits
+         * @return False if too many changes are pending
+         */
+        bool setParam(size_t node_index, uint8_t param_index, uint16_t value) noexcept;
+
+        /**
+         * @brief Seed the random generator used by nodes, the same seed, tree and inputs give the same frames.
+         * @note Reseeds the current tree and every later build, without it the seed is random. Must be called from the
+         * thread that ticks and not while \c stageBuild runs.
+         * @param seed Any value
+         */
+        void setSeed(uint64_t seed) noexcept;
+
+        /**
+         * @brief Get evaluation counts and time spent per node since the tree was built or profiles were reset.
+         * @note Constant nodes folded during the build and dead nodes are never evaluated by ticks and have no
+         * evaluations.
+         * @return Profile of every node in tree order, empty unless built with \c SPARKWEAVER_CORE_PROFILE
+         */
+        [[nodiscard]] std::vector<NodeProfile> getNodeProfiles() const noexcept;
+
+        /**
+         * @brief Zero evaluation counts and times of all nodes.
+         */
+        void resetNodeProfiles() noexcept;
+
         /**
          * @brief Get available external triggers.
+         * @note Must be called from the thread that ticks.
          * @return Valid trigger ID-s
          */
         [[nodiscard]] std::vector<uint8_t> listExternalTriggers() const noexcept;
 
         /**
-         * @brief Send external trigger.
-         * @note Triggers will activate on next tick since \c current_tick is always one step ahead of the last render.
+         * @brief Send external trigger, safe to call from any thread while another thread ticks.
+         * @note Triggers are queued and activate on the next tick, including a staged tree swapped in at that tick.
          * @param id ID of trigger
+         * @return False if too many triggers are waiting for the next tick and this one was dropped
          */
-        void triggerExternalTrigger(uint8_t id) const noexcept;
+        bool triggerExternalTrigger(uint8_t id) noexcept;
     };
 }
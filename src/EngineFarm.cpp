@@ -0,0 +1,97 @@
+#include "EngineFarm.h"
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <thread>
+
+namespace SparkWeaverCore {
+    EngineFarm::EngineFarm(const size_t threads) noexcept
+        : threads(threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency()))
+    {
+    }
+
+    void EngineFarm::add(Engine& engine, FrameSink& sink, const uint64_t frames)
+    {
+        if (frames > 0) jobs.push_back({&engine, &sink, 0, frames});
+    }
+
+    void EngineFarm::work(Run& run, const size_t self) noexcept
+    {
+        uint64_t frames = 0;
+        uint64_t steals = 0;
+        while (run.unfinished.load(std::memory_order_acquire) > 0) {
+            std::optional<Job> job;
+            {
+                // Newest slice first, usually the continuation of the engine this thread just ticked
+                auto&            own = run.queues[self];
+                std::scoped_lock lock(own.mutex);
+                if (!own.jobs.empty()) {
+                    job = own.jobs.back();
+                    own.jobs.pop_back();
+                }
+            }
+            for (size_t i = 1; !job && i < run.queues.size(); i++) {
+                auto&            other = run.queues[(self + i) % run.queues.size()];
+                std::scoped_lock lock(other.mutex);
+                if (!other.jobs.empty()) {
+                    job = other.jobs.front();
+                    other.jobs.pop_front();
+                    steals++;
+                }
+            }
+            if (!job) {
+                // Remaining slices are being ticked by other threads
+                std::this_thread::yield();
+                continue;
+            }
+
+            const auto end = std::min(job->end, job->frame + SLICE_FRAMES);
+            try {
+                for (; job->frame < end; job->frame++) {
+                    job->p_sink->write(job->frame, job->p_engine->tickUniverses());
+                    frames++;
+                }
+                if (job->frame < job->end) {
+                    auto&            own = run.queues[self];
+                    std::scoped_lock lock(own.mutex);
+                    own.jobs.push_back(*job);
+                    continue;
+                }
+            } catch (...) {
+                // Only the engine of the failed slice stops, the others keep their frames coming
+                std::scoped_lock lock(run.mutex);
+                if (!run.error) run.error = std::current_exception();
+            }
+            run.unfinished.fetch_sub(1, std::memory_order_release);
+        }
+
+        std::scoped_lock lock(run.mutex);
+        run.stats.frames += frames;
+        run.stats.steals += steals;
+    }
+
+    FarmStats EngineFarm::run()
+    {
+        const auto threads_count = std::clamp<size_t>(jobs.size(), 1, threads);
+        Run        run(threads_count, jobs.size());
+        for (size_t i = 0; i < jobs.size(); i++)
+            run.queues[i % threads_count].jobs.push_back(jobs[i]);
+        jobs.clear();
+
+        const auto start = std::chrono::steady_clock::now();
+        {
+            std::vector<std::jthread> workers;
+            for (size_t i = 1; i < threads_count; i++)
+                workers.emplace_back([&run, i] { work(run, i); });
+            work(run, 0);
+        }
+        const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (run.error) std::rethrow_exception(run.error);
+        run.stats.seconds           = seconds;
+        run.stats.frames_per_second = seconds > 0 ? run.stats.frames / seconds : 0;
+        run.stats.threads           = threads_count;
+        return run.stats;
+    }
+}
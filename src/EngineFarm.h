@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+#include "Engine.h"
+#include "TickDriver.h"
+
+namespace SparkWeaverCore {
+    /**
+     * @struct FarmStats
+     * @brief Totals of one \c EngineFarm::run.
+     */
+    struct FarmStats {
+        uint64_t frames            = 0; // Ticks of all engines
+        double   seconds           = 0; // Wall time of the run
+        double   frames_per_second = 0;
+        uint64_t steals            = 0; // Slices taken from another thread's queue
+        size_t   threads           = 0;
+    };
+
+    /**
+     * @class EngineFarm
+     * @brief Ticks many independent engines as fast as possible on a pool of threads, for offline rendering and
+     * validation of shows.
+     * @note Work is split into slices of \c SLICE_FRAMES ticks of one engine. A thread keeps running the next slice of
+     * the engine it just ticked, which stays in its cache, and an idle thread steals the oldest slice from another
+     * thread's queue. Slices of the same engine never run at the same time, so an engine and its sink are only used by
+     * one thread at a time.
+     */
+    class EngineFarm {
+        static constexpr uint64_t SLICE_FRAMES = 256;
+
+        struct Job {
+            Engine*    p_engine;
+            FrameSink* p_sink;
+            uint64_t   frame; // Next frame number passed to the sink
+            uint64_t   end;
+        };
+
+        struct alignas(64) Queue {
+            std::mutex      mutex;
+            std::deque<Job> jobs;
+        };
+
+        struct Run {
+            std::vector<Queue>  queues;
+            std::atomic<size_t> unfinished; // Jobs with frames left, slices being ticked included
+            std::mutex          mutex;      // Guards the fields below
+            FarmStats           stats{};
+            std::exception_ptr  error{};
+
+            explicit Run(const size_t threads, const size_t jobs)
+                : queues(threads)
+                , unfinished(jobs)
+            {
+            }
+        };
+
+        std::vector<Job> jobs{};
+        size_t           threads;
+
+        /**
+         * @brief Tick slices until every job is done or failed, taking from queue \c self first.
+         */
+        static void work(Run& run, size_t self) noexcept;
+
+    public:
+        /**
+         * @param threads Number of threads, 0 for one per hardware thread
+         */
+        explicit EngineFarm(size_t threads = 0) noexcept;
+
+        /**
+         * @brief Add an engine to tick in the next \c run, the engine must already be built.
+         * @param engine Engine, not used by anything else until the run returns
+         * @param sink Receives every frame of this engine in order
+         * @param frames Number of ticks
+         */
+        void add(Engine& engine, FrameSink& sink, uint64_t frames);
+
+        /**
+         * @brief Tick all added engines and wait for them, the farm is empty afterwards.
+         * @return Totals of the run
+         * @note If a sink throws, its engine is not ticked again while the other engines run to the end, then the
+         * first exception is rethrown.
+         */
+        FarmStats run();
+    };
+}
@@ -2,29 +2,51 @@
 
 #include <array>
 #include <cstdint>
+#include <span>
 #include <vector>
 
 #include "Color.h"
 #include "Config.h"
 #include "NodeConfig.h"
+#include "utils/SafeSpanReader.h"
+#include "utils/TriggerSchedule.h"
+#include "utils/random.h"
 #include "utils/string.h"
+#include "utils/varint.h"
 
 namespace SparkWeaverCore {
     class NodeLinkColor;
     class NodeLinkTrigger;
 
+    /**
+     * @struct ChannelRange
+     * @brief Range of DMX bytes, \c end is exclusive.
+     */
+    struct ChannelRange {
+        size_t start = 0;
+        size_t end   = 0;
+
+        [[nodiscard]] constexpr bool empty() const noexcept { return start >= end; }
+
+        [[nodiscard]] constexpr bool overlaps(const ChannelRange& other) const noexcept
+        {
+            return start < other.end && other.start < end;
+        }
+    };
+
     /**
      * @class Node
-     * @attention Node links should be set by \c NodeLink constructor and not modified later. Node should \c get all its
-     * inputs during each tick, even if they are not used. Functions that run after the initial tree build should never
-     * throw to avoid crashes in live environment.
+     * @attention Node links should be set by \c NodeLink and not modified later. Node should \c get all its inputs
+     * during each tick it is evaluated, even if they are not used, except for color inputs it does not select. Nodes
+     * with trigger outputs are evaluated only when a trigger input fires or at a tick passed to \c schedule, other
+     * nodes at every tick they are read. Functions that run after the initial tree build should never throw to avoid
+     * crashes in live environment. Nodes are allocated in the engine arena and must be trivially destructible.
      */
     class Node {
         static inline NodeConfig
             default_config{0, "Empty node", 0, 0, ColorOutputs::DISABLED, TriggerOutputs::DISABLED, {}};
 
-        const std::array<uint16_t, PARAMS_MAX_COUNT>
-            params{}; // Params are currently const but Nodes should support parameter changes during runtime
+        std::array<uint16_t, PARAMS_MAX_COUNT> params{}; // Changed only by Engine between ticks
 
     protected:
         explicit Node(const std::array<uint16_t, PARAMS_MAX_COUNT> params)
@@ -32,13 +54,35 @@ namespace SparkWeaverCore {
         {
         }
 
+        ~Node() = default; // Nodes live in the engine arena and are never destroyed individually
+
+        /**
+         * @brief Random integer from the generator of the engine running the node.
+         * @return Value from \c from to \c to inclusive
+         */
+        int random(const int from, const int to) const noexcept { return p_random->between(from, to); }
+
+        /**
+         * @brief Have the engine evaluate the node at a later tick even if none of its trigger inputs fire, \c wake is
+         * called first.
+         * @note A node has one pending event, scheduling again replaces it.
+         * @param tick Tick after the current one
+         */
+        void schedule(const uint32_t tick) noexcept { p_schedule->push(tick, this); }
+
     public:
-        std::vector<NodeLinkColor*>   color_inputs          = {};
-        std::vector<NodeLinkTrigger*> trigger_inputs        = {};
-        uint8_t                       color_outputs_count   = 0;
-        uint8_t                       trigger_outputs_count = 0;
+        std::span<NodeLinkColor*>   color_inputs            = {};
+        std::span<NodeLinkTrigger*> trigger_inputs          = {};
+        uint8_t                     color_outputs_count     = 0;
+        uint8_t                     trigger_outputs_count   = 0;
+        uint16_t                    color_inputs_capacity   = 0;       // Allocated color inputs, set by Engine
+        uint16_t                    trigger_inputs_capacity = 0;       // Allocated trigger inputs, set by Engine
+        uint32_t                    index                   = 0;       // Position in the tree, set by Engine
+        RandomGenerator*            p_random                = nullptr; // Generator in the engine arena, set by Engine
+        TriggerSchedule*            p_schedule              = nullptr; // Moves with the nodes on a swap, set by Engine
+        std::span<uint64_t>         storage                 = {};      // Sized by getStorageSize, set by Engine
 
-        virtual ~Node() = default;
+        uint32_t scheduled_tick = UINT32_MAX; // Tick of the pending event, set by TriggerSchedule
 
         /**
          * @brief Should be overridden by derived class to return the correct configuration.
@@ -57,6 +101,93 @@ namespace SparkWeaverCore {
             return params[n];
         }
 
+        /**
+         * @brief Set parameter value and update derived values, ignored if index is invalid.
+         * @attention Value is not validated, \c Engine::setParam checks it against the parameter configuration.
+         * @param n Parameter index
+         * @param value New value
+         */
+        void setParam(const size_t n, const uint16_t value) noexcept
+        {
+            if (n >= getConfig().params_count) return;
+            params[n] = value;
+            paramsChanged();
+        }
+
+        /**
+         * @brief Recompute values derived from parameters, called after a parameter changes. Node state is kept.
+         */
+        virtual void paramsChanged() noexcept {}
+
+        /**
+         * @brief Arena memory for state that grows with parameters, \c storage is replaced with zeroed memory when the
+         * size changes after \c paramsChanged.
+         * @return Number of words, depends only on parameters
+         */
+        [[nodiscard]] virtual size_t getStorageSize() const noexcept { return 0; }
+
+        /**
+         * @brief Take over the state of the node at the same position in the previous tree, parameters and links are
+         * kept.
+         * @param other Node of the same type
+         */
+        virtual void copyState(const Node& other) noexcept {}
+
+        /**
+         * @brief Return to the state of a newly built node, parameters and links are kept.
+         */
+        virtual void resetState() noexcept {}
+
+        /**
+         * @brief Append node state to a snapshot, parameters and links are not included.
+         * @param state Snapshot bytes, read back by \c loadState
+         */
+        virtual void saveState(std::vector<uint8_t>& state) const {}
+
+        /**
+         * @brief Take over the state written by \c saveState of a node of the same type.
+         * @param reader Reader at the state of this node
+         * @return False if the state is incomplete or invalid, the node may be left partly changed
+         */
+        virtual bool loadState(SafeSpanReader& reader) noexcept { return true; }
+
+        /**
+         * @brief Whether the output depends only on color inputs, never on the tick, triggers, randomness or state.
+         * @return True if node output can be computed once when all its color inputs are constant
+         */
+        [[nodiscard]] virtual bool isTimeInvariant() const noexcept { return false; }
+
+        /**
+         * @brief Whether \c getColor changes node state, such nodes override \c skip.
+         * @note State may depend on the tick, trigger inputs and randomness but never on color inputs.
+         * @return True if \c Engine::seek has to call \c skip on every tick
+         */
+        [[nodiscard]] virtual bool hasColorState() const noexcept { return false; }
+
+        /**
+         * @brief Advance node state through a tick without computing colors, called by \c Engine::seek instead of
+         * \c getColor.
+         * @note Must read trigger inputs and draw random numbers exactly like \c getColor, so seeking gives the same
+         * frames as ticking.
+         * @param tick Skipped tick
+         */
+        virtual void skip(uint32_t tick) noexcept {}
+
+        /**
+         * @brief Whether the output is taken from one color input at a time, the other inputs are not evaluated.
+         * @return True if \c Engine has to call \c selectInput before evaluating the color inputs
+         */
+        [[nodiscard]] virtual bool selectsInput() const noexcept { return false; }
+
+        /**
+         * @brief Color input the output is taken from at a tick, called before the color inputs are evaluated.
+         * @note Reads trigger inputs like \c getColor, only called if \c selectsInput is true and there are color
+         * inputs.
+         * @param tick Current tick
+         * @return Index in \c color_inputs
+         */
+        [[nodiscard]] virtual size_t selectInput(uint32_t tick) noexcept { return 0; }
+
         /**
          * @brief Get color output value.
          * @param tick Current tick
@@ -79,11 +210,90 @@ namespace SparkWeaverCore {
          */
         virtual void trigger(uint32_t tick) noexcept {}
 
+        /**
+         * @brief Schedule the first evaluation of a trigger node that fires without trigger inputs, called after a
+         * build, a parameter change and a state change.
+         * @note Trigger nodes are only evaluated at scheduled ticks and at ticks when one of their trigger inputs
+         * fires, their outputs are false at all other ticks.
+         * @param tick Current tick
+         */
+        virtual void start(uint32_t tick) noexcept {}
+
+        /**
+         * @brief Called at a tick passed to \c schedule, before the outputs are evaluated.
+         * @param tick Scheduled tick, earlier than the current tick if the clock was moved past it
+         */
+        virtual void wake(uint32_t tick) noexcept {}
+
         /**
          * @brief Evaluate all node inputs and render node output to a DMX packet.
          * @param tick Current tick number
-         * @param p_dmx_data Pointer to 513 bytes long array corresponding to DMX addresses, first byte is unused
+         * @param p_dmx_data Pointer to consecutive 513 bytes long universes corresponding to DMX addresses, first byte
+         * of each universe is unused
          */
         virtual void render(uint32_t tick, uint8_t* p_dmx_data) noexcept {}
+
+        /**
+         * @brief Get the bytes written by \c render.
+         * @return Range of bytes in the universes buffer, empty if node does not render
+         */
+        [[nodiscard]] virtual ChannelRange getRenderRange() const noexcept { return {}; }
     };
+
+    // Schedule members that read the pending tick of a node
+
+    inline bool TriggerSchedule::isPending(const Event& event) noexcept
+    {
+        return event.p_node->scheduled_tick == event.tick;
+    }
+
+    inline void TriggerSchedule::push(const uint32_t tick, Node* p_node) noexcept
+    {
+        if (p_node->scheduled_tick == tick) return;
+        p_node->scheduled_tick = tick;
+        if (events.size() == events.capacity()) {
+            // Replaced events go first, equal pending events once, a sorted array is a valid heap
+            std::erase_if(events, [](const Event& event) { return !isPending(event); });
+            std::ranges::sort(events);
+            const auto duplicates = std::ranges::unique(events);
+            events.erase(duplicates.begin(), duplicates.end());
+        }
+        events.push_back({tick, p_node});
+        std::ranges::push_heap(events, std::greater{});
+    }
+
+    inline bool TriggerSchedule::pop(const uint32_t tick, Event& event) noexcept
+    {
+        while (!events.empty() && events.front().tick <= tick) {
+            std::ranges::pop_heap(events, std::greater{});
+            event = events.back();
+            events.pop_back();
+            if (!isPending(event)) continue;
+            event.p_node->scheduled_tick = UINT32_MAX;
+            return true;
+        }
+        return false;
+    }
+
+    inline uint32_t TriggerSchedule::nextTick() noexcept
+    {
+        while (!events.empty() && !isPending(events.front())) {
+            std::ranges::pop_heap(events, std::greater{});
+            events.pop_back();
+        }
+        return events.empty() ? UINT32_MAX : events.front().tick;
+    }
+
+    inline void TriggerSchedule::remove(const Node* p_node) noexcept
+    {
+        std::erase_if(events, [p_node](const Event& event) { return event.p_node == p_node; });
+        std::ranges::make_heap(events, std::greater{});
+    }
+
+    inline void TriggerSchedule::clear() noexcept
+    {
+        for (const auto& event : events)
+            event.p_node->scheduled_tick = UINT32_MAX;
+        events.clear();
+    }
 }
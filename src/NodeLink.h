@@ -1,6 +1,9 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <span>
 #include <string>
 
 #include "Node.h"
@@ -23,8 +26,7 @@ namespace SparkWeaverCore {
         Node* const   input;
         const uint8_t output_index;
         const uint8_t input_index;
-        uint32_t      cache_tick  = UINT32_MAX;
-        Color         cache_value = Colors::BLACK;
+        const Color*  value = nullptr;
 
     public:
         NodeLinkColor(Node* const output, Node* const input, const uint8_t output_index, const uint8_t input_index)
@@ -41,22 +43,40 @@ namespace SparkWeaverCore {
                 throw InvalidLinkException(
                     std::string("Maximum color outputs exceeded from ") + output->getConfig().name.data());
 
-            if (input->color_inputs.size() >= input->getConfig().color_inputs_max)
+            if (input_index >= input->getConfig().color_inputs_max)
                 throw InvalidLinkException(
                     std::string("Maximum color inputs exceeded to ") + input->getConfig().name.data());
 
             output->color_outputs_count += 1;
-            if (input->color_inputs.size() <= input_index) input->color_inputs.resize(input_index + 1);
-            input->color_inputs[input_index] = this;
         }
 
-        [[nodiscard]] Color get(const uint32_t tick) noexcept
+        [[nodiscard]] Node*   getOutput() const noexcept { return output; }
+        [[nodiscard]] Node*   getInput() const noexcept { return input; }
+        [[nodiscard]] uint8_t getOutputIndex() const noexcept { return output_index; }
+        [[nodiscard]] uint8_t getInputIndex() const noexcept { return input_index; }
+
+        /**
+         * @brief Register the link in the color inputs of the input node.
+         * @attention Input list of the input node must already be allocated to fit \c input_index.
+         * @throws InvalidLinkException If the input is already connected
+         */
+        void connect()
         {
-            if (tick == cache_tick) return cache_value;
-            cache_tick  = tick;
-            cache_value = output->getColor(tick, output_index);
-            return cache_value;
+            if (input->color_inputs[input_index] != nullptr)
+                throw InvalidLinkException(
+                    std::string("Color input already connected to ") + input->getConfig().name.data());
+            input->color_inputs[input_index] = this;
         }
+
+        /**
+         * @brief Point the link to the value table slot its output node writes to during a tick.
+         * @param slot Color value written by the execution plan before any input node reads it
+         */
+        void bind(const Color* slot) noexcept { value = slot; }
+
+        [[nodiscard]] const Color* getSlot() const noexcept { return value; }
+
+        [[nodiscard]] Color get() const noexcept { return *value; }
     };
 
     class NodeLinkTrigger final {
@@ -64,8 +84,7 @@ namespace SparkWeaverCore {
         Node* const   input;
         const uint8_t output_index;
         const uint8_t input_index;
-        uint32_t      cache_tick  = UINT32_MAX;
-        bool          cache_value = false;
+        const bool*   value = nullptr;
 
     public:
         NodeLinkTrigger(Node* const output, Node* const input, const uint8_t output_index, const uint8_t input_index)
@@ -82,21 +101,52 @@ namespace SparkWeaverCore {
                 throw InvalidLinkException(
                     std::string("Maximum trigger outputs exceeded from ") + output->getConfig().name.data());
 
-            if (input->trigger_inputs.size() >= input->getConfig().trigger_inputs_max)
+            if (input_index >= input->getConfig().trigger_inputs_max)
                 throw InvalidLinkException(
                     std::string("Maximum trigger inputs exceeded to ") + input->getConfig().name.data());
 
             output->trigger_outputs_count += 1;
-            if (input->trigger_inputs.size() <= input_index) input->trigger_inputs.resize(input_index + 1);
-            input->trigger_inputs[input_index] = this;
         }
 
-        [[nodiscard]] bool get(const uint32_t tick) noexcept
+        [[nodiscard]] Node*   getOutput() const noexcept { return output; }
+        [[nodiscard]] Node*   getInput() const noexcept { return input; }
+        [[nodiscard]] uint8_t getOutputIndex() const noexcept { return output_index; }
+        [[nodiscard]] uint8_t getInputIndex() const noexcept { return input_index; }
+
+        /**
+         * @brief Register the link in the trigger inputs of the input node.
+         * @attention Input list of the input node must already be allocated to fit \c input_index.
+         * @throws InvalidLinkException If the input is already connected
+         */
+        void connect()
         {
-            if (tick == cache_tick) return cache_value;
-            cache_tick  = tick;
-            cache_value = output->getTrigger(tick, output_index);
-            return cache_value;
+            if (input->trigger_inputs[input_index] != nullptr)
+                throw InvalidLinkException(
+                    std::string("Trigger input already connected to ") + input->getConfig().name.data());
+            input->trigger_inputs[input_index] = this;
         }
+
+        /**
+         * @brief Point the link to the value table slot its output node writes to during a tick.
+         * @param slot Trigger value written by the execution plan before any input node reads it
+         */
+        void bind(const bool* slot) noexcept { value = slot; }
+
+        [[nodiscard]] bool get() const noexcept { return *value; }
     };
+
+    /**
+     * @brief Copy the values of color links next to each other for the color reductions in \c utils/colors.h.
+     * @param links Color inputs of a node
+     * @param colors Buffer for the values
+     * @return Values of all links in input order
+     */
+    inline std::span<const Color>
+    readColors(const std::span<NodeLinkColor* const> links, std::array<Color, MAXIMUM_CONNECTIONS>& colors) noexcept
+    {
+        const auto count = std::min(links.size(), colors.size());
+        for (size_t i = 0; i < count; i++)
+            colors[i] = links[i]->get();
+        return {colors.data(), count};
+    }
 }
@@ -0,0 +1,85 @@
+#include "TickDriver.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace SparkWeaverCore {
+    namespace {
+        // DMX512 line timing, break and mark after break as commonly sent, slots are 11 bits at 250 kbit/s
+        constexpr auto DMX_BREAK      = std::chrono::microseconds(92);
+        constexpr auto DMX_MARK       = std::chrono::microseconds(12);
+        constexpr auto DMX_SLOT       = std::chrono::microseconds(44);
+        constexpr auto DMX_PERIOD_MIN = std::chrono::microseconds(1204); // Shortest break to break time
+    }
+
+    TickDriver::TickDriver(Engine& engine, FrameSink& sink, const Clock::duration period) noexcept
+        : p_engine(&engine)
+        , sink(sink)
+        , period(period)
+    {
+    }
+
+    TickDriver::TickDriver(FrameRing& ring, FrameSink& sink, const Clock::duration period) noexcept
+        : p_ring(&ring)
+        , sink(sink)
+        , period(period)
+    {
+    }
+
+    TickDriver::Clock::duration TickDriver::packetPeriod(const size_t packet_size) noexcept
+    {
+        return std::max<Clock::duration>(DMX_BREAK + DMX_MARK + DMX_SLOT * packet_size, DMX_PERIOD_MIN);
+    }
+
+    void TickDriver::setPeriod(const Clock::duration new_period) noexcept
+    {
+        if (frame > 0) deadline += new_period - period;
+        period = new_period;
+    }
+
+    void TickDriver::step()
+    {
+        if (frame == 0) deadline = Clock::now();
+        std::this_thread::sleep_until(deadline);
+
+        const auto start = Clock::now();
+        if (p_engine != nullptr) {
+            sink.write(frame, p_engine->tickUniverses());
+        } else if (const auto universes = p_ring->readSlot(); !universes.empty()) {
+            sink.write(frame, universes);
+            p_ring->commitRead();
+        } else {
+            stats.underruns++; // Renderer fell behind by more than the ring, fixtures keep the previous frame
+        }
+        frame++;
+        const auto end = Clock::now();
+
+        const auto jitter = std::chrono::duration_cast<std::chrono::nanoseconds>(start - deadline).count();
+        const auto busy   = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        stats.frames++;
+        stats.jitter_total_ns += jitter;
+        stats.jitter_max_ns = std::max(stats.jitter_max_ns, jitter);
+        stats.busy_max_ns   = std::max(stats.busy_max_ns, busy);
+
+        // Stay on the grid, deadlines that already passed are skipped instead of ticking to catch up
+        deadline += period;
+        if (end > deadline && period > Clock::duration::zero()) {
+            const auto missed = (end - deadline) / period + 1;
+            stats.missed += missed;
+            deadline += missed * period;
+        }
+    }
+
+    void TickDriver::run(const uint64_t frames)
+    {
+        for (uint64_t i = 0; i < frames && !stopping.load(std::memory_order_relaxed); i++)
+            step();
+        stopping.store(false, std::memory_order_relaxed);
+    }
+
+    void TickDriver::stop() noexcept { stopping.store(true, std::memory_order_relaxed); }
+
+    const TickStats& TickDriver::getStats() const noexcept { return stats; }
+
+    void TickDriver::resetStats() noexcept { stats = {}; }
+}
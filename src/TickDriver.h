@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <vector>
+
+#include "Engine.h"
+
+namespace SparkWeaverCore {
+    /**
+     * @class FrameSink
+     * @brief Receives frames rendered by \c TickDriver, for example a DMX port, a socket or a file.
+     */
+    class FrameSink {
+    public:
+        virtual ~FrameSink() = default;
+
+        /**
+         * @brief Take one frame, called on the driver thread right after the tick.
+         * @param frame Number of the frame since the driver was created
+         * @param universes Universes as returned by \c Engine::tickUniverses or a \c FrameRing slot, valid until this
+         * returns
+         */
+        virtual void write(uint64_t frame, std::span<const uint8_t> universes) = 0;
+    };
+
+    /**
+     * @class MemoryFrameSink
+     * @brief Keeps a copy of every frame, meant for tests.
+     */
+    class MemoryFrameSink final : public FrameSink {
+        std::vector<std::vector<uint8_t>> frames{};
+
+    public:
+        void write(uint64_t, const std::span<const uint8_t> universes) override
+        {
+            frames.emplace_back(universes.begin(), universes.end());
+        }
+
+        [[nodiscard]] const std::vector<std::vector<uint8_t>>& getFrames() const noexcept { return frames; }
+    };
+
+    /**
+     * @class FileFrameSink
+     * @brief Writes frames back to back to an open file or pipe, which is not closed by the sink.
+     */
+    class FileFrameSink final : public FrameSink {
+        std::FILE* p_file;
+
+    public:
+        explicit FileFrameSink(std::FILE* p_file)
+            : p_file(p_file)
+        {
+        }
+
+        void write(uint64_t, const std::span<const uint8_t> universes) override
+        {
+            std::fwrite(universes.data(), 1, universes.size(), p_file);
+        }
+    };
+
+    /**
+     * @struct TickStats
+     * @brief Timing of the frames run by \c TickDriver, jitter is how late a tick started after its deadline.
+     */
+    struct TickStats {
+        uint64_t frames          = 0; // Deadlines served, underruns included
+        uint64_t missed          = 0; // Deadlines skipped because the previous frame ran past them
+        uint64_t underruns       = 0; // Deadlines without a rendered frame in the ring
+        int64_t  jitter_total_ns = 0; // Divide by frames for the mean
+        int64_t  jitter_max_ns   = 0;
+        int64_t  busy_max_ns     = 0; // Longest tick and sink write
+    };
+
+    /**
+     * @class TickDriver
+     * @brief Ticks an engine, or takes frames rendered ahead into a \c FrameRing, at a fixed period and passes every
+     * frame to a sink.
+     * @note Deadlines are kept on a grid from the first frame on the monotonic clock, so sleeping late does not
+     * accumulate drift. A frame running past the next deadline does not make ticks catch up in a burst, the missed
+     * deadlines are skipped and counted instead.
+     */
+    class TickDriver {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+    private:
+        Engine*           p_engine = nullptr;
+        FrameRing*        p_ring   = nullptr;
+        FrameSink&        sink;
+        Clock::duration   period;
+        Clock::time_point deadline{};
+        uint64_t          frame = 0;
+        TickStats         stats{};
+        std::atomic<bool> stopping{false};
+
+    public:
+        /**
+         * @param engine Engine to tick, the driver thread is the one that ticks
+         * @param sink Receives every frame
+         * @param period Time between ticks, see \c packetPeriod
+         */
+        TickDriver(Engine& engine, FrameSink& sink, Clock::duration period) noexcept;
+
+        /**
+         * @param ring Frames rendered ahead by \c Engine::renderAhead on another thread, the driver thread sends them
+         * @param sink Receives every frame
+         * @param period Time between frames, see \c packetPeriod
+         */
+        TickDriver(FrameRing& ring, FrameSink& sink, Clock::duration period) noexcept;
+
+        /**
+         * @brief Time to send a DMX packet on the wire: break, mark after break and 44 us per byte at 250 kbit/s.
+         * @param packet_size Bytes sent including the start code, for example \c Engine::getUsedChannels end
+         * @return Packet time, at least the shortest break to break time DMX allows
+         */
+        [[nodiscard]] static Clock::duration packetPeriod(size_t packet_size = DMX_PACKET_SIZE) noexcept;
+
+        /**
+         * @brief Change the period, the next deadline is one new period after the previous one.
+         * @note Must be called from the driver thread or while the driver is not running.
+         */
+        void setPeriod(Clock::duration new_period) noexcept;
+
+        /**
+         * @brief Sleep until the next deadline and write a frame to the sink, ticked now or the oldest in the ring.
+         * @note The first call ticks immediately and starts the deadline grid.
+         */
+        void step();
+
+        /**
+         * @brief Run frames until \c stop is called or \c frames have been run.
+         * @param frames Maximum number of frames
+         */
+        void run(uint64_t frames = UINT64_MAX);
+
+        /**
+         * @brief Make \c run return after the current frame, safe to call from any thread.
+         * @note A stop before \c run starts makes it return without running a frame.
+         */
+        void stop() noexcept;
+
+        /**
+         * @brief Get timing since the driver was created or the stats were reset.
+         * @note Must be called from the driver thread or while the driver is not running.
+         */
+        [[nodiscard]] const TickStats& getStats() const noexcept;
+
+        void resetStats() noexcept;
+    };
+}
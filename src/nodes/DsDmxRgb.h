@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+
 #include "../NodeLink.h"
 
 namespace SparkWeaverCore {
@@ -18,14 +20,44 @@ namespace SparkWeaverCore {
 
         [[nodiscard]] const NodeConfig& getConfig() const noexcept override { return config; }
 
+        [[nodiscard]] bool isTimeInvariant() const noexcept override { return true; }
+
+        [[nodiscard]] ChannelRange getRenderRange() const noexcept override
+        {
+            return renderRange(*this, getParam(0), 0);
+        }
+
         void render(const uint32_t tick, uint8_t* p_dmx_data) noexcept override
         {
-            auto address = getParam(0);
-            for (auto* color_input : color_inputs) {
-                const auto [red, green, blue] = color_input->get(tick);
-                if (address < DMX_PACKET_SIZE) p_dmx_data[address] = red;
-                if (address + 1 < DMX_PACKET_SIZE) p_dmx_data[address + 1] = green;
-                if (address + 2 < DMX_PACKET_SIZE) p_dmx_data[address + 2] = blue;
+            renderColors(*this, getParam(0), p_dmx_data);
+        }
+
+        /**
+         * @brief Get bytes written by \c renderColors.
+         * @param node Node with color inputs
+         * @param address First DMX address
+         * @param offset Offset of the universe in the universes buffer
+         * @return Range in the universes buffer
+         */
+        static ChannelRange renderRange(const Node& node, const uint16_t address, const size_t offset) noexcept
+        {
+            const auto end = std::min<size_t>(address + node.color_inputs.size() * 3, DMX_PACKET_SIZE);
+            return {offset + std::min<size_t>(address, end), offset + end};
+        }
+
+        /**
+         * @brief Write color inputs of a DMX node to consecutive channels of a single universe.
+         * @param node Node with color inputs
+         * @param address First DMX address
+         * @param p_universe Pointer to 513 bytes long array corresponding to DMX addresses, first byte is unused
+         */
+        static void renderColors(const Node& node, uint16_t address, uint8_t* p_universe) noexcept
+        {
+            for (const auto* color_input : node.color_inputs) {
+                const auto [red, green, blue] = color_input->get();
+                if (address < DMX_PACKET_SIZE) p_universe[address] = red;
+                if (address + 1 < DMX_PACKET_SIZE) p_universe[address + 1] = green;
+                if (address + 2 < DMX_PACKET_SIZE) p_universe[address + 2] = blue;
                 address += 3;
             }
         }
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "DsDmxRgb.h"
+
+namespace SparkWeaverCore {
+    /**
+     * @class DsDmxRgbUniverse
+     * @brief Sequentially outputs RGB colors to DMX channels starting at a given address in a given universe.
+     */
+    class DsDmxRgbUniverse final : public Node {
+    public:
+        static const NodeConfig config;
+
+        explicit DsDmxRgbUniverse(const std::array<uint16_t, PARAMS_MAX_COUNT> params)
+            : Node(params)
+        {
+        }
+
+        [[nodiscard]] const NodeConfig& getConfig() const noexcept override { return config; }
+
+        [[nodiscard]] bool isTimeInvariant() const noexcept override { return true; }
+
+        [[nodiscard]] ChannelRange getRenderRange() const noexcept override
+        {
+            const auto universe = getParam(1);
+            if (universe >= UNIVERSES_MAX) return {};
+            return DsDmxRgb::renderRange(*this, getParam(0), universe * DMX_PACKET_SIZE);
+        }
+
+        void render(const uint32_t tick, uint8_t* p_dmx_data) noexcept override
+        {
+            const auto universe = getParam(1);
+            if (universe >= UNIVERSES_MAX) return;
+            DsDmxRgb::renderColors(*this, getParam(0), p_dmx_data + universe * DMX_PACKET_SIZE);
+        }
+    };
+
+    constexpr NodeConfig DsDmxRgbUniverse::config = NodeConfig(
+        TypeIds::DsDmxRgbUniverse,
+        "DMX RGB universe",
+        MAXIMUM_CONNECTIONS,
+        0,
+        ColorOutputs::DISABLED,
+        TriggerOutputs::DISABLED,
+        {{"address", 1, 512, 1}, {"universe", 0, UNIVERSES_MAX - 1, 0}});
+}
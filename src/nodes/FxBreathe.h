@@ -1,9 +1,10 @@
 #pragma once
 
-#include <cmath>
+#include <algorithm>
 #include <cstdint>
 
 #include "../NodeLink.h"
+#include "../utils/fixed.h"
 
 namespace SparkWeaverCore {
     /**
@@ -11,28 +12,37 @@ namespace SparkWeaverCore {
      * @brief Sinusoidal dimming of input color.
      */
     class FxBreathe final : public Node {
+        uint32_t phase_step = 0; // Angle step per tick
+        uint32_t darken     = 0; // Darken amount as Q16 gain
+
     public:
         static const NodeConfig config;
 
         explicit FxBreathe(const std::array<uint16_t, PARAMS_MAX_COUNT> params)
             : Node(params)
         {
+            FxBreathe::paramsChanged();
         }
 
         [[nodiscard]] const NodeConfig& getConfig() const noexcept override { return config; }
 
+        void paramsChanged() noexcept override
+        {
+            phase_step = Fixed::turnStep(getParam(0));
+            darken     = (std::min<uint32_t>(getParam(2), 0xFF) * GAIN_UNITY + 0x7F) / 0xFF;
+        }
+
         [[nodiscard]] Color getColor(const uint32_t tick, const uint8_t index) noexcept override
         {
-            constexpr static double pi            = 3.14159265358979323846;
-            const uint16_t          cycle_length  = getParam(0);
-            const uint16_t          phase_offset  = getParam(1);
-            const float             darken_amount = static_cast<float>(getParam(2)) / 0xFF;
+            const uint16_t cycle_length = std::max<uint16_t>(getParam(0), 1);
+            const uint16_t phase_offset = getParam(1);
 
             if (color_inputs.empty()) return Colors::BLACK;
-            const Color color = color_inputs.at(0)->get(tick);
-            const auto  cycle_value =
-                static_cast<float>(0.5 * (1.0 + std::sin((phase_offset + tick) * 2.0 * pi / cycle_length)));
-            return color * (1 - darken_amount + cycle_value * darken_amount);
+            const Color color = color_inputs[0]->get();
+            const auto  angle = (phase_offset + tick) % cycle_length * phase_step;
+            // Sine mapped from -1..1 to 0..1 in Q16
+            const auto cycle_value = static_cast<uint32_t>(Fixed::sine(angle) + 0x8000);
+            return color.scaled(GAIN_UNITY - darken + ((cycle_value * darken + 0x8000) >> 16));
         }
     };
 
@@ -3,6 +3,7 @@
 #include <cstdint>
 
 #include "../NodeLink.h"
+#include "../utils/fixed.h"
 
 namespace SparkWeaverCore {
     /**
@@ -11,6 +12,20 @@ namespace SparkWeaverCore {
      */
     class FxPulse final : public Node {
         uint32_t pulse_tick = UINT32_MAX;
+        uint64_t attack_reciprocal = 0;
+        uint64_t decay_reciprocal  = 0;
+
+        void readTriggers(const uint32_t tick) noexcept
+        {
+            const auto length    = getParam(0) + getParam(1) + getParam(2);
+            const auto retrigger = getParam(3);
+
+            for (auto* trigger_input : trigger_inputs) {
+                if (trigger_input->get() && (retrigger || pulse_tick == UINT32_MAX || pulse_tick + length <= tick)) {
+                    pulse_tick = tick;
+                }
+            }
+        }
 
     public:
         static const NodeConfig config;
@@ -18,31 +33,53 @@ namespace SparkWeaverCore {
         explicit FxPulse(const std::array<uint16_t, PARAMS_MAX_COUNT> params)
             : Node(params)
         {
+            FxPulse::paramsChanged();
         }
 
         [[nodiscard]] const NodeConfig& getConfig() const noexcept override { return config; }
 
+        void copyState(const Node& other) noexcept override
+        {
+            const auto& from = static_cast<const FxPulse&>(other);
+            pulse_tick       = from.pulse_tick;
+        }
+
+        void resetState() noexcept override { pulse_tick = UINT32_MAX; }
+
+        void saveState(std::vector<uint8_t>& state) const override { writeVarint(state, pulse_tick); }
+
+        bool loadState(SafeSpanReader& reader) noexcept override
+        {
+            if (!reader.hasVarint()) return false;
+            pulse_tick = reader.readVarint();
+            return true;
+        }
+
+        void paramsChanged() noexcept override
+        {
+            attack_reciprocal = Fixed::reciprocal(getParam(0));
+            decay_reciprocal  = Fixed::reciprocal(getParam(2));
+        }
+
+        [[nodiscard]] bool hasColorState() const noexcept override { return true; }
+
+        void skip(const uint32_t tick) noexcept override { readTriggers(tick); }
+
         [[nodiscard]] Color getColor(const uint32_t tick, const uint8_t index) noexcept override
         {
-            const auto attack    = getParam(0);
-            const auto sustain   = getParam(1);
-            const auto decay     = getParam(2);
-            const auto retrigger = getParam(3);
+            const uint32_t attack  = getParam(0);
+            const uint32_t sustain = getParam(1);
+            const uint32_t decay   = getParam(2);
 
-            for (auto* trigger_input : trigger_inputs) {
-                if (trigger_input->get(tick) &&
-                    (retrigger || pulse_tick == UINT32_MAX || pulse_tick + attack + sustain + decay <= tick)) {
-                    pulse_tick = tick;
-                }
-            }
+            readTriggers(tick);
 
             if (const auto phase = tick - pulse_tick;
                 pulse_tick != UINT32_MAX && !color_inputs.empty() && phase < attack + sustain + decay) {
-                const auto color = color_inputs.at(0)->get(tick);
-                if (phase < attack) return color * (static_cast<float>(phase) / static_cast<float>(attack));
+                const auto color = color_inputs[0]->get();
+                if (phase < attack) return color.scaled(Fixed::ratio(phase, attack_reciprocal));
                 if (phase < attack + sustain) return color;
                 if (phase < attack + sustain + decay)
-                    return color * (1 - static_cast<float>(phase - attack - sustain) / static_cast<float>(decay));
+                    return color.scaled(GAIN_UNITY - Fixed::ratio(phase - attack - sustain, decay_reciprocal));
             }
             return Colors::BLACK;
         }
@@ -12,6 +12,15 @@ namespace SparkWeaverCore {
     class FxStrobe final : public Node {
         uint32_t flash_tick = UINT32_MAX;
 
+        void readTriggers(const uint32_t tick) noexcept
+        {
+            for (auto* trigger_input : trigger_inputs) {
+                if (trigger_input->get()) {
+                    flash_tick = tick;
+                }
+            }
+        }
+
     public:
         static const NodeConfig config;
 
@@ -22,18 +31,35 @@ namespace SparkWeaverCore {
 
         [[nodiscard]] const NodeConfig& getConfig() const noexcept override { return config; }
 
+        void copyState(const Node& other) noexcept override
+        {
+            const auto& from = static_cast<const FxStrobe&>(other);
+            flash_tick       = from.flash_tick;
+        }
+
+        void resetState() noexcept override { flash_tick = UINT32_MAX; }
+
+        void saveState(std::vector<uint8_t>& state) const override { writeVarint(state, flash_tick); }
+
+        bool loadState(SafeSpanReader& reader) noexcept override
+        {
+            if (!reader.hasVarint()) return false;
+            flash_tick = reader.readVarint();
+            return true;
+        }
+
+        [[nodiscard]] bool hasColorState() const noexcept override { return true; }
+
+        void skip(const uint32_t tick) noexcept override { readTriggers(tick); }
+
         [[nodiscard]] Color getColor(const uint32_t tick, const uint8_t index) noexcept override
         {
             const auto length = getParam(0);
 
-            for (auto* trigger_input : trigger_inputs) {
-                if (trigger_input->get(tick)) {
-                    flash_tick = tick;
-                }
-            }
+            readTriggers(tick);
 
             if (color_inputs.empty()) return Colors::BLACK;
-            const auto color = color_inputs.at(0)->get(tick);
+            const auto color = color_inputs[0]->get();
 
             if (tick >= flash_tick && tick < flash_tick + length) return color;
             return Colors::BLACK;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../NodeLink.h"
+#include "../utils/colors.h"
 
 namespace SparkWeaverCore {
     /**
@@ -18,13 +19,12 @@ namespace SparkWeaverCore {
 
         [[nodiscard]] const NodeConfig& getConfig() const noexcept override { return config; }
 
+        [[nodiscard]] bool isTimeInvariant() const noexcept override { return true; }
+
         [[nodiscard]] Color getColor(const uint32_t tick, const uint8_t index) noexcept override
         {
-            auto color = Colors::BLACK;
-            for (auto* color_input : color_inputs) {
-                color = color + color_input->get(tick);
-            }
-            return color;
+            std::array<Color, MAXIMUM_CONNECTIONS> colors;
+            return sumColors(readColors(color_inputs, colors));
         }
     };
 
@@ -22,7 +22,7 @@ namespace SparkWeaverCore {
         {
             auto trigger = false;
             for (auto* trigger_input : trigger_inputs) {
-                trigger = trigger_input->get(tick) || trigger;
+                trigger = trigger_input->get() || trigger;
             }
             return trigger;
         }
@@ -12,6 +12,23 @@ namespace SparkWeaverCore {
         uint8_t  active_index = 0;
         uint32_t last_tick    = UINT32_MAX;
 
+        void readTriggers(const uint32_t tick) noexcept
+        {
+            if (tick == last_tick) return;
+            last_tick    = tick;
+            auto trigger = false;
+            for (auto* trigger_input : trigger_inputs) {
+                trigger = trigger_input->get() || trigger;
+            }
+            if (trigger) {
+                if (getParam(0) == 1) {
+                    active_index = random(0, color_outputs_count - 1); // count > 0, otherwise nothing calls this
+                } else {
+                    active_index = (active_index + 1) % color_outputs_count;
+                }
+            }
+        }
+
     public:
         static const NodeConfig config;
 
@@ -22,28 +39,44 @@ namespace SparkWeaverCore {
 
         [[nodiscard]] const NodeConfig& getConfig() const noexcept override { return config; }
 
+        void copyState(const Node& other) noexcept override
+        {
+            const auto& from = static_cast<const MxSequence&>(other);
+            active_index     = from.active_index;
+            last_tick        = from.last_tick;
+        }
+
+        void resetState() noexcept override
+        {
+            active_index = 0;
+            last_tick    = UINT32_MAX;
+        }
+
+        void saveState(std::vector<uint8_t>& state) const override
+        {
+            state.push_back(active_index);
+            writeVarint(state, last_tick);
+        }
+
+        bool loadState(SafeSpanReader& reader) noexcept override
+        {
+            if (!reader.hasByte()) return false;
+            active_index = reader.readByte();
+            if (!reader.hasVarint()) return false;
+            last_tick = reader.readVarint();
+            return true;
+        }
+
+        [[nodiscard]] bool hasColorState() const noexcept override { return true; }
+
+        void skip(const uint32_t tick) noexcept override { readTriggers(tick); }
+
         [[nodiscard]] Color getColor(const uint32_t tick, const uint8_t index) noexcept override
         {
-            const auto    output_random = getParam(0) == 1;
-            const uint8_t index_max     = color_outputs_count - 1; // count > 0, otherwise getColor wouldn't be called
-
-            if (tick != last_tick) {
-                last_tick    = tick;
-                auto trigger = false;
-                for (auto* trigger_input : trigger_inputs) {
-                    trigger = trigger_input->get(tick) || trigger;
-                }
-                if (trigger) {
-                    if (output_random) {
-                        active_index = random(0, index_max);
-                    } else {
-                        active_index = (active_index + 1) % color_outputs_count;
-                    }
-                }
-            }
+            readTriggers(tick);
 
             if (color_inputs.empty()) return Colors::BLACK;
-            const auto color = color_inputs.at(0)->get(tick);
+            const auto color = color_inputs[0]->get();
             if (index == active_index) return color;
             return Colors::BLACK;
         }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../NodeLink.h"
+#include "../utils/colors.h"
 
 namespace SparkWeaverCore {
     /**
@@ -18,16 +19,12 @@ namespace SparkWeaverCore {
 
         [[nodiscard]] const NodeConfig& getConfig() const noexcept override { return config; }
 
+        [[nodiscard]] bool isTimeInvariant() const noexcept override { return true; }
+
         [[nodiscard]] Color getColor(const uint32_t tick, const uint8_t index) noexcept override
         {
-            auto color = Colors::BLACK;
-            if (!color_inputs.empty()) {
-                color = color_inputs.at(0)->get(tick);
-                for (int i = 1; i < color_inputs.size(); i++) {
-                    color = color - color_inputs.at(i)->get(tick);
-                }
-            }
-            return color;
+            std::array<Color, MAXIMUM_CONNECTIONS> colors;
+            return differenceColors(readColors(color_inputs, colors));
         }
     };
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+
 #include "../NodeLink.h"
 #include "../utils/random.h"
 
@@ -12,6 +14,23 @@ namespace SparkWeaverCore {
         uint8_t  active_index = 0;
         uint32_t last_tick    = UINT32_MAX;
 
+        void readTriggers(const uint32_t tick) noexcept
+        {
+            if (tick == last_tick) return;
+            last_tick    = tick;
+            auto trigger = false;
+            for (auto* trigger_input : trigger_inputs) {
+                trigger = trigger_input->get() || trigger;
+            }
+            if (trigger && !color_inputs.empty()) {
+                if (getParam(0) == 1) {
+                    active_index = random(0, static_cast<int>(color_inputs.size()) - 1);
+                } else {
+                    active_index = (active_index + 1) % color_inputs.size();
+                }
+            }
+        }
+
     public:
         static const NodeConfig config;
 
@@ -22,28 +41,55 @@ namespace SparkWeaverCore {
 
         [[nodiscard]] const NodeConfig& getConfig() const noexcept override { return config; }
 
-        [[nodiscard]] Color getColor(const uint32_t tick, const uint8_t index) noexcept override
+        void copyState(const Node& other) noexcept override
         {
-            const auto    input_random = getParam(0) == 1;
-            const uint8_t index_max    = color_inputs.empty() ? 0 : color_inputs.size() - 1;
+            const auto& from = static_cast<const MxSwitch&>(other);
+            active_index     = from.active_index;
+            last_tick        = from.last_tick;
+        }
 
-            if (tick != last_tick) {
-                last_tick    = tick;
-                auto trigger = false;
-                for (auto* trigger_input : trigger_inputs) {
-                    trigger = trigger_input->get(tick) || trigger;
-                }
-                if (trigger) {
-                    if (input_random) {
-                        active_index = random(0, index_max);
-                    } else {
-                        active_index = (active_index + 1) % color_inputs.size();
-                    }
-                }
-            }
+        void resetState() noexcept override
+        {
+            active_index = 0;
+            last_tick    = UINT32_MAX;
+        }
+
+        void saveState(std::vector<uint8_t>& state) const override
+        {
+            state.push_back(active_index);
+            writeVarint(state, last_tick);
+        }
+
+        bool loadState(SafeSpanReader& reader) noexcept override
+        {
+            if (!reader.hasByte()) return false;
+            active_index = reader.readByte();
+            if (!reader.hasVarint()) return false;
+            last_tick = reader.readVarint();
+            return true;
+        }
+
+        [[nodiscard]] bool hasColorState() const noexcept override { return true; }
+
+        void skip(const uint32_t tick) noexcept override { readTriggers(tick); }
+
+        [[nodiscard]] bool selectsInput() const noexcept override { return true; }
 
-            if (color_inputs.empty()) return Colors::BLACK;
-            return color_inputs.at(active_index)->get(tick);
+        [[nodiscard]] size_t selectInput(const uint32_t tick) noexcept override
+        {
+            readTriggers(tick);
+
+            // Index may come from a tree with more inputs
+            return std::min<size_t>(active_index, color_inputs.size() - 1);
+        }
+
+        [[nodiscard]] Color getColor(const uint32_t tick, const uint8_t index) noexcept override
+        {
+            if (color_inputs.empty()) {
+                readTriggers(tick);
+                return Colors::BLACK;
+            }
+            return color_inputs[selectInput(tick)]->get();
         }
     };
 
@@ -18,6 +18,8 @@ namespace SparkWeaverCore {
 
         [[nodiscard]] const NodeConfig& getConfig() const noexcept override { return config; }
 
+        [[nodiscard]] bool isTimeInvariant() const noexcept override { return true; }
+
         [[nodiscard]] Color getColor(const uint32_t tick, const uint8_t index) noexcept override
         {
             const uint8_t red   = getParam(0);
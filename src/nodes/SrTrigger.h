@@ -20,6 +20,23 @@ namespace SparkWeaverCore {
 
         [[nodiscard]] const NodeConfig& getConfig() const noexcept override { return config; }
 
+        void copyState(const Node& other) noexcept override
+        {
+            const auto& from = static_cast<const SrTrigger&>(other);
+            next_trigger     = from.next_trigger;
+        }
+
+        void resetState() noexcept override { next_trigger = UINT32_MAX; }
+
+        void saveState(std::vector<uint8_t>& state) const override { writeVarint(state, next_trigger); }
+
+        bool loadState(SafeSpanReader& reader) noexcept override
+        {
+            if (!reader.hasVarint()) return false;
+            next_trigger = reader.readVarint();
+            return true;
+        }
+
         void trigger(const uint32_t tick) noexcept override { next_trigger = tick; }
 
         [[nodiscard]] bool getTrigger(const uint32_t tick, const uint8_t index) noexcept override
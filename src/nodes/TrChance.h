@@ -22,6 +22,34 @@ namespace SparkWeaverCore {
 
         [[nodiscard]] const NodeConfig& getConfig() const noexcept override { return config; }
 
+        void copyState(const Node& other) noexcept override
+        {
+            const auto& from = static_cast<const TrChance&>(other);
+            last_tick        = from.last_tick;
+            last_value       = from.last_value;
+        }
+
+        void resetState() noexcept override
+        {
+            last_tick  = UINT32_MAX;
+            last_value = false;
+        }
+
+        void saveState(std::vector<uint8_t>& state) const override
+        {
+            writeVarint(state, last_tick);
+            state.push_back(last_value);
+        }
+
+        bool loadState(SafeSpanReader& reader) noexcept override
+        {
+            if (!reader.hasVarint()) return false;
+            last_tick = reader.readVarint();
+            if (!reader.hasByte()) return false;
+            last_value = reader.readByte() != 0;
+            return true;
+        }
+
         [[nodiscard]] bool getTrigger(const uint32_t tick, const uint8_t index) noexcept override
         {
             const auto chance = getParam(0);
@@ -30,7 +58,7 @@ namespace SparkWeaverCore {
                 last_tick    = tick;
                 auto trigger = false;
                 for (auto* trigger_input : trigger_inputs) {
-                    trigger = trigger_input->get(tick) || trigger;
+                    trigger = trigger_input->get() || trigger;
                 }
                 last_value = trigger && chance > random(0, PARAM_MAX_VALUE - 1);
             }
@@ -18,6 +18,20 @@ namespace SparkWeaverCore {
 
         [[nodiscard]] const NodeConfig& getConfig() const noexcept override { return config; }
 
+        void start(const uint32_t tick) noexcept override
+        {
+            const uint16_t cycle_length = getParam(0);
+            const uint16_t phase_offset = getParam(1);
+            const auto     remainder    = (tick + phase_offset) % cycle_length;
+            schedule(remainder == 0 ? tick : tick + cycle_length - remainder);
+        }
+
+        void wake(const uint32_t tick) noexcept override
+        {
+            // Events scheduled before a parameter change may be off the cycle
+            if (getTrigger(tick, 0)) schedule(tick + getParam(0));
+        }
+
         [[nodiscard]] bool getTrigger(const uint32_t tick, const uint8_t index) noexcept override
         {
             const uint16_t cycle_length = getParam(0);
@@ -1,16 +1,62 @@
 #pragma once
 
+#include <algorithm>
+#include <bit>
+
 #include "../NodeLink.h"
 
 namespace SparkWeaverCore {
     /**
      * @class TrDelay
      * @brief Delays input trigger a set number of ticks.
+     * @note Triggers on their way are bits in a ring with one slot per tick of the delay, kept in the arena, and only
+     * the earliest is scheduled. Changing the delay drops triggers on their way.
      */
     class TrDelay final : public Node {
-        uint32_t          last_tick = UINT32_MAX;
-        std::vector<bool> buffer    = {false, false};
-        size_t            head      = 0;
+        static constexpr size_t WORD_BITS = 64;
+
+        uint32_t last_tick     = UINT32_MAX;
+        uint32_t fire_tick     = UINT32_MAX; // Set by a scheduled event, read on that tick
+        uint32_t pending_count = 0;          // Set bits in storage
+
+        [[nodiscard]] uint32_t getDelay() const noexcept { return std::max<uint16_t>(getParam(0), 1); }
+
+        [[nodiscard]] bool isPending(const uint32_t tick) const noexcept
+        {
+            const auto slot = tick % getDelay();
+            return storage[slot / WORD_BITS] >> slot % WORD_BITS & 1;
+        }
+
+        void flipPending(const uint32_t tick) noexcept
+        {
+            const auto slot = tick % getDelay();
+            storage[slot / WORD_BITS] ^= uint64_t{1} << slot % WORD_BITS;
+        }
+
+        /**
+         * @brief Schedule the earliest trigger on its way, they all fire within one delay after the tick.
+         */
+        void scheduleAfter(const uint32_t tick) noexcept
+        {
+            if (pending_count == 0) return;
+            const auto delay = getDelay();
+            for (uint32_t offset = 1; offset <= delay;) {
+                const auto slot = (tick + offset) % delay;
+                const auto bits = storage[slot / WORD_BITS] >> slot % WORD_BITS;
+                if (bits != 0) {
+                    schedule(tick + offset + std::countr_zero(bits));
+                    return;
+                }
+                // Bits past the delay are never set, the ring continues at slot 0
+                offset += std::min<uint32_t>(WORD_BITS - slot % WORD_BITS, delay - slot);
+            }
+        }
+
+        void clearPending() noexcept
+        {
+            std::ranges::fill(storage, 0);
+            pending_count = 0;
+        }
 
     public:
         static const NodeConfig config;
@@ -22,25 +68,93 @@ namespace SparkWeaverCore {
 
         [[nodiscard]] const NodeConfig& getConfig() const noexcept override { return config; }
 
-        [[nodiscard]] bool getTrigger(const uint32_t tick, const uint8_t index) noexcept override
+        [[nodiscard]] size_t getStorageSize() const noexcept override
+        {
+            return (getDelay() + WORD_BITS - 1) / WORD_BITS;
+        }
+
+        void paramsChanged() noexcept override { clearPending(); }
+
+        void copyState(const Node& other) noexcept override
         {
-            const auto delay = getParam(0) + 1;
+            const auto& from = static_cast<const TrDelay&>(other);
+            last_tick        = from.last_tick;
+            fire_tick        = from.fire_tick;
+            if (from.getDelay() == getDelay()) {
+                std::ranges::copy(from.storage, storage.begin());
+                pending_count = from.pending_count;
+            } else {
+                clearPending();
+            }
+        }
+
+        void resetState() noexcept override
+        {
+            last_tick = UINT32_MAX;
+            fire_tick = UINT32_MAX;
+            clearPending();
+        }
+
+        void saveState(std::vector<uint8_t>& state) const override
+        {
+            writeVarint(state, last_tick);
+            writeVarint(state, fire_tick);
+            writeVarint(state, pending_count);
+            // Triggers on their way fire in the delay after the last evaluation, written in firing order
+            for (uint32_t offset = 1; offset <= (pending_count == 0 ? 0 : getDelay()); offset++) {
+                if (isPending(last_tick + offset)) writeVarint(state, last_tick + offset);
+            }
+        }
+
+        bool loadState(SafeSpanReader& reader) noexcept override
+        {
+            clearPending();
+            if (!reader.hasVarint()) return false;
+            last_tick = reader.readVarint();
+            if (!reader.hasVarint()) return false;
+            fire_tick = reader.readVarint();
+            if (!reader.hasVarint()) return false;
+            const auto count = reader.readVarint();
+            if (count > getDelay()) return false;
+            for (size_t i = 0; i < count; i++) {
+                if (!reader.hasVarint()) return false;
+                const auto tick = reader.readVarint();
+                if (tick <= last_tick || tick - last_tick > getDelay() || isPending(tick)) return false;
+                flipPending(tick);
+                pending_count++;
+            }
+            return true;
+        }
+
+        void start(const uint32_t tick) noexcept override { scheduleAfter(last_tick); }
 
+        void wake(const uint32_t tick) noexcept override
+        {
+            // Event may be left from before the delay changed and the ring was emptied
+            if (isPending(tick)) {
+                flipPending(tick);
+                pending_count--;
+                fire_tick = tick;
+            }
+            scheduleAfter(tick);
+        }
+
+        [[nodiscard]] bool getTrigger(const uint32_t tick, const uint8_t index) noexcept override
+        {
             if (tick != last_tick) {
-                if (buffer.size() != delay) {
-                    head = 0;
-                    buffer.assign(delay, false);
-                }
                 last_tick    = tick;
                 auto trigger = false;
                 for (auto* trigger_input : trigger_inputs) {
-                    trigger = trigger_input->get(tick) || trigger;
+                    trigger = trigger_input->get() || trigger;
+                }
+                // Slot of the current tick was emptied by wake, earlier triggers fire before this one
+                if (trigger && !isPending(tick)) {
+                    flipPending(tick);
+                    if (pending_count++ == 0) schedule(tick + getDelay());
                 }
-                buffer[head] = trigger;
-                head         = (head + 1) % delay;
             }
 
-            return buffer[head];
+            return tick == fire_tick;
         }
     };
 
@@ -51,5 +165,5 @@ namespace SparkWeaverCore {
         MAXIMUM_CONNECTIONS,
         ColorOutputs::DISABLED,
         TriggerOutputs::ENABLED,
-        {{"delay_ticks", 1, 0xFF, 40}});
+        {{"delay_ticks", 1, PARAM_MAX_VALUE, 40}});
 }
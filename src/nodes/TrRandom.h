@@ -21,6 +21,29 @@ namespace SparkWeaverCore {
 
         [[nodiscard]] const NodeConfig& getConfig() const noexcept override { return config; }
 
+        void copyState(const Node& other) noexcept override
+        {
+            const auto& from = static_cast<const TrRandom&>(other);
+            next_trigger     = from.next_trigger;
+        }
+
+        void resetState() noexcept override { next_trigger = UINT32_MAX; }
+
+        void saveState(std::vector<uint8_t>& state) const override { writeVarint(state, next_trigger); }
+
+        bool loadState(SafeSpanReader& reader) noexcept override
+        {
+            if (!reader.hasVarint()) return false;
+            next_trigger = reader.readVarint();
+            return true;
+        }
+
+        void start(const uint32_t tick) noexcept override
+        {
+            if (trigger_inputs.empty() && (next_trigger == UINT32_MAX || tick > next_trigger)) schedule(tick);
+            else if (next_trigger != UINT32_MAX && next_trigger >= tick) schedule(next_trigger);
+        }
+
         [[nodiscard]] bool getTrigger(const uint32_t tick, const uint8_t index) noexcept override
         {
             const auto min_time = getParam(0);
@@ -29,10 +52,15 @@ namespace SparkWeaverCore {
             auto trigger = false;
             if (trigger_inputs.empty()) trigger = tick > next_trigger || next_trigger == UINT32_MAX;
             for (auto* trigger_input : trigger_inputs) {
-                trigger = trigger_input->get(tick) || trigger;
+                trigger = trigger_input->get() || trigger;
             }
 
-            if (trigger) next_trigger = tick + random(min_time, max_time);
+            if (trigger) {
+                next_trigger = tick + random(min_time, max_time);
+                if (next_trigger > tick) schedule(next_trigger);
+            }
+            // Without inputs the next interval is drawn on the tick after the trigger
+            if (trigger_inputs.empty() && next_trigger == tick) schedule(tick + 1);
             return tick == next_trigger;
         }
     };
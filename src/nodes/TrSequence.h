@@ -23,6 +23,39 @@ namespace SparkWeaverCore {
 
         [[nodiscard]] const NodeConfig& getConfig() const noexcept override { return config; }
 
+        void copyState(const Node& other) noexcept override
+        {
+            const auto& from = static_cast<const TrSequence&>(other);
+            active_index     = from.active_index;
+            last_tick        = from.last_tick;
+            last_value       = from.last_value;
+        }
+
+        void resetState() noexcept override
+        {
+            active_index = UINT8_MAX;
+            last_tick    = UINT32_MAX;
+            last_value   = false;
+        }
+
+        void saveState(std::vector<uint8_t>& state) const override
+        {
+            state.push_back(active_index);
+            writeVarint(state, last_tick);
+            state.push_back(last_value);
+        }
+
+        bool loadState(SafeSpanReader& reader) noexcept override
+        {
+            if (!reader.hasByte()) return false;
+            active_index = reader.readByte();
+            if (!reader.hasVarint()) return false;
+            last_tick = reader.readVarint();
+            if (!reader.hasByte()) return false;
+            last_value = reader.readByte() != 0;
+            return true;
+        }
+
         [[nodiscard]] bool getTrigger(const uint32_t tick, const uint8_t index) noexcept override
         {
             const auto    output_random = getParam(0) == 1;
@@ -32,7 +65,7 @@ namespace SparkWeaverCore {
                 last_tick  = tick;
                 last_value = false;
                 for (auto* trigger_input : trigger_inputs) {
-                    last_value = trigger_input->get(tick) || last_value;
+                    last_value = trigger_input->get() || last_value;
                 }
                 if (last_value) {
                     if (output_random) {
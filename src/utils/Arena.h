@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace SparkWeaverCore {
+    /**
+     * @class Arena
+     * @brief Bump allocator for objects that live as long as the node tree.
+     * @note Destructors are never run, \c clear only rewinds so the blocks are reused by the next tree without
+     * returning memory to the heap. Objects removed from a running tree are given back with \c release and their
+     * memory is reused by later allocations of the same size.
+     */
+    class Arena final {
+        static constexpr size_t BLOCK_MIN_SIZE = 1024;
+
+        struct Block {
+            std::unique_ptr<std::byte[]> data;
+            size_t                       size;
+        };
+
+        // Released memory of one size, every entry starts with a pointer to the next one
+        struct FreeList {
+            size_t size;
+            void*  p_head;
+        };
+
+        std::vector<Block>    blocks{};
+        size_t                block = 0;
+        size_t                used  = 0;
+        std::vector<FreeList> free_lists{};
+
+    public:
+        /**
+         * @brief Allocate uninitialized memory, adds a block if the remaining blocks are too small.
+         * @param size Bytes to allocate
+         * @param alignment Required alignment, power of two
+         * @return Pointer to allocated memory
+         */
+        [[nodiscard]] void* allocate(const size_t size, const size_t alignment)
+        {
+            for (auto& [list_size, p_head] : free_lists) {
+                if (list_size != size || p_head == nullptr) continue;
+                if (reinterpret_cast<uintptr_t>(p_head) & (alignment - 1)) break;
+                const auto p = p_head;
+                std::memcpy(&p_head, p, sizeof(void*));
+                return p;
+            }
+
+            while (block < blocks.size()) {
+                const auto address = reinterpret_cast<uintptr_t>(blocks[block].data.get()) + used;
+                const auto padding = (0 - address) & (alignment - 1); // Alignment is a power of two
+                if (used + padding + size <= blocks[block].size) {
+                    used += padding + size;
+                    return blocks[block].data.get() + used - size;
+                }
+                block++;
+                used = 0;
+            }
+
+            const auto block_size =
+                std::max({BLOCK_MIN_SIZE, size + alignment, blocks.empty() ? 0 : blocks.back().size * 2});
+            blocks.push_back({std::make_unique_for_overwrite<std::byte[]>(block_size), block_size});
+            block = blocks.size() - 1;
+            used  = 0;
+            return allocate(size, alignment);
+        }
+
+        /**
+         * @brief Give back memory of an object that is no longer used, the next allocation of the same size reuses it.
+         * @note Memory smaller than a pointer is not reused.
+         * @param p Memory returned by \c allocate, may be nullptr
+         * @param size Bytes allocated
+         */
+        void release(void* p, const size_t size)
+        {
+            if (p == nullptr || size < sizeof(void*)) return;
+            auto list = std::ranges::find(free_lists, size, &FreeList::size);
+            if (list == free_lists.end()) list = free_lists.insert(list, {size, nullptr});
+            std::memcpy(p, &list->p_head, sizeof(void*)); // Memory may not be aligned for a pointer
+            list->p_head = p;
+        }
+
+        template <typename T, typename... Args>
+        [[nodiscard]] T* create(Args&&... args)
+        {
+            static_assert(std::is_trivially_destructible_v<T>, "Arena never runs destructors");
+            const auto p = allocate(sizeof(T), alignof(T));
+            try {
+                return new (p) T(std::forward<Args>(args)...);
+            } catch (...) {
+                release(p, sizeof(T)); // Links validate in their constructor
+                throw;
+            }
+        }
+
+        template <typename T>
+        [[nodiscard]] std::span<T> createArray(const size_t count, const T& value)
+        {
+            static_assert(std::is_trivially_destructible_v<T>, "Arena never runs destructors");
+            if (count == 0) return {};
+            const auto p_array = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+            for (size_t i = 0; i < count; i++)
+                new (p_array + i) T(value);
+            return {p_array, count};
+        }
+
+        /**
+         * @brief Forget all objects in constant time, blocks are kept for reuse.
+         */
+        void clear() noexcept
+        {
+            block = 0;
+            used  = 0;
+            free_lists.clear();
+        }
+
+        [[nodiscard]] size_t capacity() const noexcept
+        {
+            size_t total = 0;
+            for (const auto& [data, size] : blocks)
+                total += size;
+            return total;
+        }
+    };
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace SparkWeaverCore {
+    /**
+     * @class FrameRing
+     * @brief Fixed number of frame slots passed from one rendering thread to one sending thread without locks.
+     * @note The renderer fills slots ahead of the sender, so a slow frame is absorbed by the frames already waiting.
+     * Only slot indexes are shared, frame bytes are written before the write index is published and read before the
+     * read index is.
+     */
+    class FrameRing final {
+        std::vector<uint8_t> frames;
+        size_t               frame_size;
+        size_t               slots;
+
+        alignas(64) std::atomic<size_t> write_index{0}; // Frames committed by the renderer
+        alignas(64) std::atomic<size_t> read_index{0};  // Frames released by the sender
+
+    public:
+        /**
+         * @param frame_size Bytes in every frame, for example \c DMX_PACKET_SIZE times the universe count
+         * @param slots Number of frames the renderer can be ahead, at least 1
+         */
+        FrameRing(const size_t frame_size, const size_t slots)
+            : frames(frame_size * (slots == 0 ? 1 : slots))
+            , frame_size(frame_size)
+            , slots(slots == 0 ? 1 : slots)
+        {
+        }
+
+        FrameRing(const FrameRing&)            = delete;
+        FrameRing& operator=(const FrameRing&) = delete;
+
+        [[nodiscard]] size_t getFrameSize() const noexcept { return frame_size; }
+        [[nodiscard]] size_t getSlotCount() const noexcept { return slots; }
+
+        /**
+         * @brief Get the number of frames waiting to be sent, approximate while the other thread is working.
+         */
+        [[nodiscard]] size_t getFrameCount() const noexcept
+        {
+            return write_index.load(std::memory_order_acquire) - read_index.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief Get the slot to render the next frame into, renderer thread only.
+         * @return Free slot, empty if all slots hold frames not sent yet
+         */
+        [[nodiscard]] std::span<uint8_t> writeSlot() noexcept
+        {
+            const auto index = write_index.load(std::memory_order_relaxed);
+            if (index - read_index.load(std::memory_order_acquire) == slots) return {};
+            return {frames.data() + index % slots * frame_size, frame_size};
+        }
+
+        /**
+         * @brief Hand the frame written to \c writeSlot to the sender, renderer thread only.
+         */
+        void commitWrite() noexcept { write_index.fetch_add(1, std::memory_order_release); }
+
+        /**
+         * @brief Get the oldest frame, sender thread only.
+         * @return Frame, empty if no frame is waiting
+         */
+        [[nodiscard]] std::span<const uint8_t> readSlot() const noexcept
+        {
+            const auto index = read_index.load(std::memory_order_relaxed);
+            if (index == write_index.load(std::memory_order_acquire)) return {};
+            return {frames.data() + index % slots * frame_size, frame_size};
+        }
+
+        /**
+         * @brief Return the slot of the frame from \c readSlot to the renderer, sender thread only.
+         */
+        void commitRead() noexcept { read_index.fetch_add(1, std::memory_order_release); }
+    };
+}
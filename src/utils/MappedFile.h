@@ -0,0 +1,88 @@
+#pragma once
+
+#if __has_include(<sys/mman.h>)
+#include <cerrno>
+#include <cstdint>
+#include <span>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SPARKWEAVER_CORE_MAPPED_FILE
+
+namespace SparkWeaverCore {
+    /**
+     * @class MappedFile
+     * @brief Read only memory mapping of a file, pages are loaded by the OS on first access and shared with the page
+     * cache instead of being copied.
+     * @note Only available where \c mmap is, \c SPARKWEAVER_CORE_MAPPED_FILE is defined if it is.
+     */
+    class MappedFile final {
+        const uint8_t* data = nullptr;
+        size_t         size = 0;
+
+    public:
+        /**
+         * @brief Map the whole file.
+         * @param path File path
+         * @throws std::system_error If the file cannot be opened or mapped
+         */
+        explicit MappedFile(const char* path)
+        {
+            const int fd = open(path, O_RDONLY | O_CLOEXEC);
+            if (fd < 0) throw std::system_error(errno, std::generic_category(), path);
+
+            struct stat info {};
+            if (fstat(fd, &info) != 0) {
+                const auto error = errno;
+                close(fd);
+                throw std::system_error(error, std::generic_category(), path);
+            }
+
+            // Empty files cannot be mapped, they give an empty span
+            if (info.st_size > 0) {
+                void* p_map = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p_map == MAP_FAILED) {
+                    const auto error = errno;
+                    close(fd);
+                    throw std::system_error(error, std::generic_category(), path);
+                }
+                data = static_cast<const uint8_t*>(p_map);
+                size = info.st_size;
+            }
+            close(fd); // Mapping stays valid without the descriptor
+        }
+
+        MappedFile(const MappedFile&)            = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile(MappedFile&& other) noexcept
+            : data(std::exchange(other.data, nullptr))
+            , size(std::exchange(other.size, 0))
+        {
+        }
+
+        MappedFile& operator=(MappedFile&& other) noexcept
+        {
+            std::swap(data, other.data);
+            std::swap(size, other.size);
+            return *this;
+        }
+
+        ~MappedFile()
+        {
+            if (data != nullptr) munmap(const_cast<uint8_t*>(data), size);
+        }
+
+        /**
+         * @brief Get the file contents.
+         * @return Bytes of the file, valid while this object exists
+         */
+        [[nodiscard]] std::span<const uint8_t> bytes() const noexcept { return {data, size}; }
+    };
+}
+#endif
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace SparkWeaverCore {
+    /**
+     * @class MpscQueue
+     * @brief Bounded lock-free queue, any number of threads may push while a single thread pops.
+     * @note Every cell carries a sequence number telling whether it is free for the producer at a position or filled
+     * for the consumer, so neither side waits on the other. Pushing to a full queue fails instead of blocking.
+     * @tparam T Trivially copyable value
+     * @tparam Capacity Number of cells, a power of two
+     */
+    template <typename T, size_t Capacity>
+    class MpscQueue final {
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+        struct Cell {
+            std::atomic<size_t> sequence;
+            T                   value;
+        };
+
+        std::array<Cell, Capacity> cells;
+        alignas(64) std::atomic<size_t> tail{0}; // Next position claimed by a producer
+        alignas(64) size_t head = 0;             // Next position read by the consumer
+
+    public:
+        MpscQueue() noexcept
+        {
+            for (size_t i = 0; i < Capacity; i++)
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        MpscQueue(const MpscQueue&)            = delete;
+        MpscQueue& operator=(const MpscQueue&) = delete;
+
+        /**
+         * @brief Add a value, safe to call from any thread.
+         * @return False if the queue is full
+         */
+        bool push(const T value) noexcept
+        {
+            auto pos = tail.load(std::memory_order_relaxed);
+            for (;;) {
+                auto&      cell     = cells[pos & (Capacity - 1)];
+                const auto sequence = cell.sequence.load(std::memory_order_acquire);
+                if (const auto diff = static_cast<ptrdiff_t>(sequence - pos); diff == 0) {
+                    // Cell is free at this position, claim it unless another producer was faster
+                    if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        cell.value = value;
+                        cell.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false; // Consumer has not read the value a full lap ago yet
+                } else {
+                    pos = tail.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /**
+         * @brief Take the oldest value, must only be called from the consumer thread.
+         * @return False if the queue is empty or the oldest push has not finished
+         */
+        bool pop(T& value) noexcept
+        {
+            auto& cell = cells[head & (Capacity - 1)];
+            if (cell.sequence.load(std::memory_order_acquire) != head + 1) return false;
+            value = cell.value;
+            cell.sequence.store(head + Capacity, std::memory_order_release);
+            head++;
+            return true;
+        }
+    };
+}
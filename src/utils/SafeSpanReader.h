@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+namespace SparkWeaverCore {
+    /**
+     * @class SafeSpanReader
+     * @brief Returns zero if read is out of bounds, use \c hasByte, \c hasShort and \c hasVarint to check before
+     * reading.
+     * @note Bytes are read in place and must outlive the reader.
+     */
+    class SafeSpanReader final {
+        static constexpr size_t  VARINT_MAX_SIZE      = 5;
+        static constexpr uint8_t VARINT_LAST_BYTE_MAX = 0x0F; // Bits 28 to 31
+
+        std::span<const uint8_t> bytes;
+        size_t                   head = 0;
+
+    public:
+        explicit SafeSpanReader(const std::span<const uint8_t> bytes)
+            : bytes(bytes)
+        {
+        }
+
+        [[nodiscard]] size_t position() const noexcept { return head; }
+        [[nodiscard]] bool   hasByte() const noexcept { return head < bytes.size(); }
+        [[nodiscard]] bool   hasShort() const noexcept { return head + 1 < bytes.size(); }
+        [[nodiscard]] bool   hasBytes(const size_t count) const noexcept { return head + count - 1 < bytes.size(); }
+        [[nodiscard]] size_t remaining() const noexcept { return bytes.size() - head; }
+
+        /**
+         * @brief Check for a complete unsigned LEB128 varint of at most 5 bytes that fits in 32 bits.
+         * @return False if the varint runs past the end or its fifth byte has bits above bit 31
+         */
+        [[nodiscard]] bool hasVarint() const noexcept
+        {
+            for (auto i = head; i < bytes.size() && i < head + VARINT_MAX_SIZE; i++) {
+                if (i == head + VARINT_MAX_SIZE - 1) return bytes[i] <= VARINT_LAST_BYTE_MAX;
+                if (bytes[i] < 0x80) return true;
+            }
+            return false;
+        }
+
+        [[nodiscard]] uint8_t readByte() noexcept
+        {
+            if (!hasByte()) return 0;
+            return bytes[head++];
+        }
+
+        [[nodiscard]] uint16_t readShort() noexcept
+        {
+            if (!hasShort()) return 0;
+            const auto lsb = readByte();
+            const auto msb = readByte();
+            return static_cast<uint16_t>(msb) << 8 | lsb;
+        }
+
+        /**
+         * @brief Read a varint checked by \c hasVarint.
+         * @return Value or zero without moving the position if \c hasVarint is false
+         */
+        [[nodiscard]] uint32_t readVarint() noexcept
+        {
+            if (!hasVarint()) return 0;
+            uint32_t value = 0;
+            for (size_t i = 0; i < VARINT_MAX_SIZE; i++) {
+                const auto byte = bytes[head + i];
+                value |= static_cast<uint32_t>(byte & 0x7F) << 7 * i;
+                if (byte < 0x80) {
+                    head += i + 1;
+                    return value;
+                }
+            }
+            return 0;
+        }
+    };
+}
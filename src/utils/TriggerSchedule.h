@@ -0,0 +1,77 @@
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace SparkWeaverCore {
+    class Node;
+
+    /**
+     * @class TriggerSchedule
+     * @brief Ticks at which trigger nodes fire or have to look at their state again, so ticks without events skip
+     * trigger nodes entirely.
+     * @note Events are kept in a binary heap. A node has at most one pending event, \c Node::scheduled_tick, and
+     * scheduling it again leaves the earlier event in the heap to be skipped. When the heap is full the skipped events
+     * are dropped, so memory reserved for twice the trigger nodes is never outgrown. Members that read the node are
+     * defined in Node.h.
+     */
+    class TriggerSchedule final {
+    public:
+        struct Event {
+            uint32_t tick;
+            Node*    p_node;
+
+            auto operator<=>(const Event&) const = default;
+        };
+
+    private:
+        std::vector<Event> events{};
+
+    public:
+        /**
+         * @return True if the event is still the pending event of its node
+         */
+        [[nodiscard]] static bool isPending(const Event& event) noexcept;
+
+        /**
+         * @brief Make an event the pending event of its node, replacing an earlier one.
+         * @attention Allocates only if more nodes have events than were reserved for.
+         */
+        void push(uint32_t tick, Node* p_node) noexcept;
+
+        /**
+         * @brief Take the earliest event due at a tick, it is no longer pending afterwards.
+         * @param tick Current tick, events of earlier ticks are due as well
+         * @param event Receives the event
+         * @return False if no event is due
+         */
+        bool pop(uint32_t tick, Event& event) noexcept;
+
+        /**
+         * @return Tick of the earliest event, \c UINT32_MAX if there is none
+         */
+        [[nodiscard]] uint32_t nextTick() noexcept;
+
+        /**
+         * @return Events in no particular order, replaced events that are no longer pending included
+         */
+        [[nodiscard]] std::span<const Event> getEvents() const noexcept { return events; }
+
+        /**
+         * @brief Drop the event of a node, before its memory is reused.
+         */
+        void remove(const Node* p_node) noexcept;
+
+        /**
+         * @brief Room for the events of a tree, called when the number of trigger nodes changes.
+         * @param nodes_count Nodes that may have a pending event
+         */
+        void reserve(const size_t nodes_count) { events.reserve(2 * std::max<size_t>(nodes_count, 1)); }
+
+        void clear() noexcept;
+    };
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+
+#include "../Color.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SPARKWEAVER_CORE_AVX2
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SPARKWEAVER_CORE_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SPARKWEAVER_CORE_NEON
+#endif
+
+namespace SparkWeaverCore {
+    static_assert(sizeof(Color) == 3, "Color arrays are processed as packed RGB bytes");
+
+    namespace ColorKernels {
+        /**
+         * @brief Saturating sum of packed colors, one vector of whole colors at a time.
+         * @note Saturating byte addition is associative, so summing every channel of a color in its own lane and
+         * folding the lanes at the end gives the same result as adding colors one by one. A vector holds the bytes of
+         * \c LANE_COLORS colors, the lanes after them are loaded but ignored.
+         */
+        template <size_t VECTOR_SIZE, typename Vector, typename Load, typename Add, typename Store>
+        Color sum(const std::span<const Color> colors, Load load, Add add, Store store) noexcept
+        {
+            constexpr size_t LANE_COLORS = VECTOR_SIZE / sizeof(Color);
+            constexpr size_t STEP        = LANE_COLORS * sizeof(Color);
+
+            const auto p_bytes = reinterpret_cast<const uint8_t*>(colors.data());
+            const auto size    = colors.size() * sizeof(Color);
+            Vector     total   = load(std::array<uint8_t, VECTOR_SIZE>{}.data());
+            size_t     i       = 0;
+            for (; i + VECTOR_SIZE <= size; i += STEP)
+                total = add(total, load(p_bytes + i));
+
+            // Remaining colors fit in a single vector, read through a copy so nothing past the array is loaded
+            std::array<uint8_t, VECTOR_SIZE> tail{};
+            std::copy(p_bytes + i, p_bytes + size, tail.begin());
+            total = add(total, load(tail.data()));
+
+            std::array<uint8_t, VECTOR_SIZE> lanes;
+            store(lanes.data(), total);
+            auto result = Colors::BLACK;
+            for (size_t lane = 0; lane < STEP; lane += sizeof(Color))
+                result = result + Color{lanes[lane], lanes[lane + 1], lanes[lane + 2]};
+            return result;
+        }
+    }
+
+    /**
+     * @brief Saturating sum of all colors, same as adding them one by one with \c Color::operator+.
+     * @note Uses AVX2, SSE2 or NEON saturating byte additions where available.
+     * @return Sum or black if there are no colors
+     */
+    inline Color sumColors(const std::span<const Color> colors) noexcept
+    {
+#if defined(SPARKWEAVER_CORE_AVX2)
+        return ColorKernels::sum<32, __m256i>(
+            colors,
+            [](const uint8_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); },
+            [](const __m256i a, const __m256i b) { return _mm256_adds_epu8(a, b); },
+            [](uint8_t* p, const __m256i a) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), a); });
+#elif defined(SPARKWEAVER_CORE_SSE2)
+        return ColorKernels::sum<16, __m128i>(
+            colors,
+            [](const uint8_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); },
+            [](const __m128i a, const __m128i b) { return _mm_adds_epu8(a, b); },
+            [](uint8_t* p, const __m128i a) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), a); });
+#elif defined(SPARKWEAVER_CORE_NEON)
+        return ColorKernels::sum<16, uint8x16_t>(
+            colors,
+            [](const uint8_t* p) { return vld1q_u8(p); },
+            [](const uint8x16_t a, const uint8x16_t b) { return vqaddq_u8(a, b); },
+            [](uint8_t* p, const uint8x16_t a) { vst1q_u8(p, a); });
+#else
+        // Saturation only clips at the top, so one clamp of the full sum gives the same result
+        uint32_t r = 0, g = 0, b = 0;
+        for (const auto& color : colors) {
+            r += color.r;
+            g += color.g;
+            b += color.b;
+        }
+        return {
+            static_cast<uint8_t>(std::min<uint32_t>(r, 0xFF)),
+            static_cast<uint8_t>(std::min<uint32_t>(g, 0xFF)),
+            static_cast<uint8_t>(std::min<uint32_t>(b, 0xFF))};
+#endif
+    }
+
+    /**
+     * @brief First color minus all other colors, same as subtracting them one by one with \c Color::operator-.
+     * @return Difference or black if there are no colors
+     */
+    inline Color differenceColors(const std::span<const Color> colors) noexcept
+    {
+        if (colors.empty()) return Colors::BLACK;
+        const auto subtrahend = sumColors(colors.subspan(1));
+        return colors[0] - subtrahend;
+    }
+}
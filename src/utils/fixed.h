@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace SparkWeaverCore {
+    /**
+     * Fixed-point helpers for effects, angles are fractions of a full turn in Q32 and gains are Q16 (see
+     * \c GAIN_UNITY).
+     */
+    namespace Fixed {
+        constexpr int SINE_TABLE_BITS = 10;
+        constexpr int SINE_TABLE_SIZE = 1 << SINE_TABLE_BITS;
+
+        // Taylor series after reducing to [-pi, pi], std::sin is not constexpr
+        constexpr double sineTaylor(const double turns)
+        {
+            constexpr double pi = 3.14159265358979323846;
+            const double     x  = (turns > 0.5 ? turns - 1 : turns) * 2 * pi;
+            double           term = x, sum = x;
+            for (int n = 1; n < 16; n++) {
+                term *= -x * x / ((2 * n) * (2 * n + 1));
+                sum += term;
+            }
+            return sum;
+        }
+
+        // One full turn, the extra entry equals the first so interpolation never wraps
+        constexpr std::array<int16_t, SINE_TABLE_SIZE + 1> SINE_TABLE = [] {
+            std::array<int16_t, SINE_TABLE_SIZE + 1> table{};
+            for (int i = 0; i <= SINE_TABLE_SIZE; i++) {
+                const auto value = sineTaylor(static_cast<double>(i % SINE_TABLE_SIZE) / SINE_TABLE_SIZE) * 32767;
+                table[i]         = static_cast<int16_t>(value < 0 ? value - 0.5 : value + 0.5);
+            }
+            return table;
+        }();
+
+        /**
+         * @brief Sine from the table with linear interpolation.
+         * @param angle Fraction of a full turn, 2^32 is one turn
+         * @return Sine scaled to -32767..32767
+         */
+        constexpr int32_t sine(const uint32_t angle) noexcept
+        {
+            const auto    index    = angle >> (32 - SINE_TABLE_BITS);
+            const int32_t fraction = (angle >> (16 - SINE_TABLE_BITS)) & 0xFFFF;
+            const int32_t low      = SINE_TABLE[index];
+            return low + ((SINE_TABLE[index + 1] - low) * fraction >> 16);
+        }
+
+        /**
+         * @brief Angle step of a period, multiply by the position in the period to get the angle.
+         * @param period Period length, 0 and 1 give a zero step
+         * @return Fraction of a full turn per step, 2^32 is one turn
+         */
+        constexpr uint32_t turnStep(const uint16_t period) noexcept
+        {
+            if (period <= 1) return 0;
+            return static_cast<uint32_t>((uint64_t{1} << 32) / period);
+        }
+
+        /**
+         * @brief Reciprocal used by \c ratio, computed once per divisor.
+         * @param divisor Divisor, 0 gives 0
+         * @return 2^32 / \c divisor rounded
+         */
+        constexpr uint64_t reciprocal(const uint16_t divisor) noexcept
+        {
+            if (divisor == 0) return 0;
+            return ((uint64_t{1} << 32) + divisor / 2) / divisor;
+        }
+
+        /**
+         * @brief Ratio of \c numerator to a divisor as a Q16 gain.
+         * @param numerator Numerator, at most the divisor
+         * @param divisor_reciprocal Result of \c reciprocal for the divisor
+         * @return numerator / divisor where 65536 is 1
+         */
+        constexpr uint32_t ratio(const uint32_t numerator, const uint64_t divisor_reciprocal) noexcept
+        {
+            return static_cast<uint32_t>((numerator * divisor_reciprocal + 0x8000) >> 16);
+        }
+    }
+}
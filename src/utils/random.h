@@ -1,14 +1,79 @@
 #pragma once
 
-#include <random>
+#include <array>
+#include <cstdint>
 
 namespace SparkWeaverCore {
-    inline int random(const int from, const int to)
-    {
-        if (from >= to) return from;
-        static std::random_device     random_device;
-        static std::mt19937           mersenne_twister_engine(random_device());
-        std::uniform_int_distribution distribution(from, to);
-        return distribution(mersenne_twister_engine);
-    }
+    /**
+     * @class RandomGenerator
+     * @brief xoshiro128++ generator, 32-bit operations only and 16 bytes of state, each engine owns one so trees on
+     * different threads do not share state and a seed reproduces a show.
+     */
+    class RandomGenerator final {
+        std::array<uint32_t, 4> state{};
+
+        static constexpr uint32_t rotl(const uint32_t x, const int k) noexcept { return x << k | x >> (32 - k); }
+
+    public:
+        /**
+         * @param seed Any value, expanded with SplitMix64 so similar seeds give unrelated sequences
+         */
+        explicit constexpr RandomGenerator(uint64_t seed) noexcept
+        {
+            for (size_t i = 0; i < state.size(); i += 2) {
+                auto z = seed += 0x9E3779B97F4A7C15;
+                z      = (z ^ z >> 30) * 0xBF58476D1CE4E5B9;
+                z      = (z ^ z >> 27) * 0x94D049BB133111EB;
+                z ^= z >> 31;
+                state[i]     = static_cast<uint32_t>(z);
+                state[i + 1] = static_cast<uint32_t>(z >> 32);
+            }
+        }
+
+        [[nodiscard]] constexpr const std::array<uint32_t, 4>& getState() const noexcept { return state; }
+
+        /**
+         * @brief Continue the sequence of a generator whose state was saved with \c getState.
+         * @return False if the state is all zero, which xoshiro cannot leave, the state is not changed
+         */
+        constexpr bool setState(const std::array<uint32_t, 4>& new_state) noexcept
+        {
+            if (new_state == std::array<uint32_t, 4>{}) return false;
+            state = new_state;
+            return true;
+        }
+
+        constexpr uint32_t next() noexcept
+        {
+            const auto result = rotl(state[0] + state[3], 7) + state[0];
+            const auto t      = state[1] << 9;
+            state[2] ^= state[0];
+            state[3] ^= state[1];
+            state[1] ^= state[2];
+            state[0] ^= state[3];
+            state[2] ^= t;
+            state[3] = rotl(state[3], 11);
+            return result;
+        }
+
+        /**
+         * @brief Uniform integer without bias, multiply and shift with a rare retry instead of a division per call.
+         * @return Value from \c from to \c to inclusive, \c from if the range is empty
+         */
+        constexpr int between(const int from, const int to) noexcept
+        {
+            if (from >= to) return from;
+            const auto range = static_cast<uint32_t>(to - from) + 1;
+            if (range == 0) return static_cast<int>(next()); // Full 32-bit range
+
+            auto product = static_cast<uint64_t>(next()) * range;
+            if (static_cast<uint32_t>(product) < range) {
+                // Low part below 2^32 mod range would make some results more likely
+                const auto threshold = -range % range;
+                while (static_cast<uint32_t>(product) < threshold)
+                    product = static_cast<uint64_t>(next()) * range;
+            }
+            return static_cast<int>(static_cast<uint32_t>(from) + static_cast<uint32_t>(product >> 32));
+        }
+    };
 }
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace SparkWeaverCore {
+    /**
+     * @brief Append an unsigned LEB128 varint, read back by \c SafeSpanReader::readVarint.
+     * @param bytes Destination
+     * @param value Value, below 128 takes one byte
+     */
+    inline void writeVarint(std::vector<uint8_t>& bytes, uint32_t value)
+    {
+        while (value >= 0x80) {
+            bytes.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        bytes.push_back(static_cast<uint8_t>(value));
+    }
+}
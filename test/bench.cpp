@@ -0,0 +1,759 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <SparkWeaverCore.h>
+
+#include "trees.h"
+
+namespace {
+    std::atomic<size_t> allocations = 0;
+    volatile uint32_t   sink        = 0; // Receives measured results so the optimizer keeps the loops
+
+    void* allocate(const size_t size, const size_t alignment = 0)
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        // aligned_alloc needs the size to be a multiple of the alignment
+        const auto p = alignment == 0 ? std::malloc(size == 0 ? 1 : size)
+                                      : std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+        if (p) return p;
+        throw std::bad_alloc();
+    }
+}
+
+// Every form of new and delete is replaced so aligned allocations are counted too and each pair uses the same
+// allocator. All stay out of line, GCC would otherwise see malloc() and free() across a new and delete pair and warn.
+
+[[gnu::noinline]] void* operator new(const size_t size) { return allocate(size); }
+
+[[gnu::noinline]] void* operator new[](const size_t size) { return allocate(size); }
+
+[[gnu::noinline]] void* operator new(const size_t size, const std::align_val_t alignment)
+{
+    return allocate(size, static_cast<size_t>(alignment));
+}
+
+[[gnu::noinline]] void* operator new[](const size_t size, const std::align_val_t alignment)
+{
+    return allocate(size, static_cast<size_t>(alignment));
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept { std::free(p); }
+
+[[gnu::noinline]] void operator delete[](void* p) noexcept { std::free(p); }
+
+[[gnu::noinline]] void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+[[gnu::noinline]] void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+[[gnu::noinline]] void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+
+[[gnu::noinline]] void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+
+[[gnu::noinline]] void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+[[gnu::noinline]] void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+namespace {
+    using namespace SparkWeaverCore;
+    using namespace Trees;
+
+    struct Shape {
+        std::string_view name;
+        void (*generate)(TreeWriter&, Random&, int);
+    };
+
+    struct TypeProfile {
+        const NodeConfig* p_config;
+        uint64_t          evaluations;
+        uint64_t          nanoseconds;
+    };
+
+    struct Result {
+        std::string_view shape;
+        size_t           nodes;
+        size_t           dead_nodes; // Left out of evaluation, no output reaches a destination
+        size_t           links;
+        size_t           bytes;
+        size_t           compact_bytes; // Compact version with evaluation order
+        double           build_us;
+        double           compact_build_us;
+        size_t           build_allocations;
+        size_t           rebuild_allocations;
+        double           tick_ns;
+        size_t           tick_allocations;
+        double           seek_ns; // Per tick skipped by Engine::seek
+        size_t           state_bytes;
+        double           restore_us;
+
+        std::vector<TypeProfile> profile; // Empty unless built with SPARKWEAVER_CORE_PROFILE
+    };
+
+    /**
+     * @brief Sum node profiles of the engine by node type.
+     */
+    std::vector<TypeProfile> typeProfile(const Engine& engine)
+    {
+        std::vector<TypeProfile> profile;
+        for (const auto& [index, type_id, evaluations, nanoseconds] : engine.getNodeProfiles()) {
+            auto type = std::ranges::find(profile, type_id, [](const auto& type) { return type.p_config->type_id; });
+            if (type == profile.end()) type = profile.insert(type, {&TreeWriter::config(type_id), 0, 0});
+            type->evaluations += evaluations;
+            type->nanoseconds += nanoseconds;
+        }
+        return profile;
+    }
+
+    Result measure(const Shape& shape, const int nodes_count, const int ticks, const int builds)
+    {
+        Random     random(nodes_count);
+        TreeWriter writer;
+        shape.generate(writer, random, nodes_count);
+        const auto tree = writer.bytes();
+
+        Engine engine;
+        auto   count = allocations.load();
+        engine.build(tree);
+        const auto build_allocations = allocations.load() - count;
+
+        count            = allocations.load();
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < builds; i++)
+            engine.build(tree);
+        const auto end                 = std::chrono::steady_clock::now();
+        const auto rebuild_allocations = (allocations.load() - count) / builds;
+
+        const auto compact       = engine.exportTree();
+        const auto compact_start = std::chrono::steady_clock::now();
+        for (int i = 0; i < builds; i++)
+            engine.build(compact);
+        const auto compact_end = std::chrono::steady_clock::now();
+
+        count                       = allocations.load();
+        const auto tick_start       = std::chrono::steady_clock::now();
+        for (int i = 0; i < ticks; i++)
+            sink = engine.tick()[1];
+        const auto tick_end         = std::chrono::steady_clock::now();
+        const auto tick_allocations = allocations.load() - count;
+
+        const auto seek_start = std::chrono::steady_clock::now();
+        engine.seek(engine.getTick() + ticks);
+        const auto seek_end = std::chrono::steady_clock::now();
+
+        const auto state         = engine.saveState();
+        const auto restore_start = std::chrono::steady_clock::now();
+        engine.restoreState(state);
+        const auto restore_end = std::chrono::steady_clock::now();
+
+        return {
+            shape.name,
+            writer.nodesCount(),
+            engine.getDeadNodeCount(),
+            writer.linksCount(),
+            tree.size(),
+            compact.size(),
+            std::chrono::duration<double, std::micro>(end - start).count() / builds,
+            std::chrono::duration<double, std::micro>(compact_end - compact_start).count() / builds,
+            build_allocations,
+            rebuild_allocations,
+            std::chrono::duration<double, std::nano>(tick_end - tick_start).count() / ticks,
+            tick_allocations,
+            std::chrono::duration<double, std::nano>(seek_end - seek_start).count() / ticks,
+            state.size(),
+            std::chrono::duration<double, std::micro>(restore_end - restore_start).count(),
+            typeProfile(engine)};
+    }
+
+    struct MathResult {
+        std::string_view effect;
+        double           float_ns;  // Float math as it was before the fixed-point path
+        double           fixed_ns;
+        int              max_error; // Largest channel difference between the engine and float math
+    };
+
+    Color breatheFloat(
+        const Color color, const uint32_t tick, const uint16_t cycle, const uint16_t phase, const uint16_t darken)
+    {
+        constexpr double pi            = 3.14159265358979323846;
+        const float      darken_amount = static_cast<float>(darken) / 0xFF;
+        const auto       cycle_value   = static_cast<float>(0.5 * (1.0 + std::sin((phase + tick) * 2.0 * pi / cycle)));
+        return color * (1 - darken_amount + cycle_value * darken_amount);
+    }
+
+    Color breatheFixed(
+        const Color color, const uint32_t tick, const uint16_t cycle, const uint16_t phase, const uint16_t darken)
+    {
+        const auto step        = Fixed::turnStep(cycle);
+        const auto gain        = (darken * GAIN_UNITY + 0x7F) / 0xFF;
+        const auto cycle_value = static_cast<uint32_t>(Fixed::sine((phase + tick) % cycle * step) + 0x8000);
+        return color.scaled(GAIN_UNITY - gain + ((cycle_value * gain + 0x8000) >> 16));
+    }
+
+    Color pulseFloat(
+        const Color color, const uint32_t phase, const uint32_t attack, const uint32_t sustain, const uint32_t decay)
+    {
+        if (phase < attack) return color * (static_cast<float>(phase) / static_cast<float>(attack));
+        if (phase < attack + sustain) return color;
+        if (phase < attack + sustain + decay)
+            return color * (1 - static_cast<float>(phase - attack - sustain) / static_cast<float>(decay));
+        return Colors::BLACK;
+    }
+
+    Color pulseFixed(
+        const Color color, const uint32_t phase, const uint32_t attack, const uint32_t sustain, const uint32_t decay)
+    {
+        if (phase < attack) return color.scaled(Fixed::ratio(phase, Fixed::reciprocal(attack)));
+        if (phase < attack + sustain) return color;
+        if (phase < attack + sustain + decay)
+            return color.scaled(GAIN_UNITY - Fixed::ratio(phase - attack - sustain, Fixed::reciprocal(decay)));
+        return Colors::BLACK;
+    }
+
+    int maxChannelError(const Color a, const Color b)
+    {
+        return std::max({std::abs(a.r - b.r), std::abs(a.g - b.g), std::abs(a.b - b.b)});
+    }
+
+    /**
+     * @brief Time a color kernel over all fixtures and ticks.
+     * @return Nanoseconds per call
+     */
+    template <typename Kernel>
+    double nanosecondsPerCall(const size_t fixtures, const int ticks, Kernel kernel)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (int tick = 0; tick < ticks; tick++)
+            for (size_t i = 0; i < fixtures; i++)
+                sink = kernel(i, tick).r;
+        const auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count() / (static_cast<double>(fixtures) * ticks);
+    }
+
+    /**
+     * @brief Compare breathe and pulse nodes against the float math they used before, on a full universe of fixtures
+     * with random colors and parameters.
+     */
+    std::vector<MathResult> measureMath(const int ticks)
+    {
+        constexpr int fixtures = 170;
+        struct Fixture {
+            Color    color;
+            uint16_t params[4]; // Effect parameters, pulses also keep their trigger cycle length
+        };
+
+        std::vector<MathResult> results;
+        for (const auto effect : {TypeIds::FxBreathe, TypeIds::FxPulse}) {
+            Random               random(effect);
+            TreeWriter           writer;
+            std::vector<Fixture> setup;
+            for (int i = 0; i < fixtures; i++) {
+                const Color color = {
+                    static_cast<uint8_t>(randomParam(random, 0, 0xFF)),
+                    static_cast<uint8_t>(randomParam(random, 0, 0xFF)),
+                    static_cast<uint8_t>(randomParam(random, 0, 0xFF))};
+                const auto dmx    = writer.node(TypeIds::DsDmxRgb, {static_cast<uint16_t>(1 + i * 3)});
+                const auto source = writer.node(TypeIds::SrColor, {color.r, color.g, color.b});
+                if (effect == TypeIds::FxBreathe) {
+                    const Fixture fixture{
+                        color,
+                        {randomParam(random, 1, 5000), randomParam(random, 0, 5000), randomParam(random, 0, 0xFF)}};
+                    const auto breathe = writer.node(
+                        TypeIds::FxBreathe, {fixture.params[0], fixture.params[1], fixture.params[2]});
+                    writer.color(breathe, dmx);
+                    writer.color(source, breathe);
+                    setup.push_back(fixture);
+                } else {
+                    const Fixture fixture{
+                        color,
+                        {randomParam(random, 1, 300),
+                         randomParam(random, 1, 50),
+                         randomParam(random, 1, 300),
+                         randomParam(random, 1, 1000)}};
+                    const auto pulse = writer.node(
+                        TypeIds::FxPulse, {fixture.params[0], fixture.params[1], fixture.params[2], 1});
+                    const auto cycle = writer.node(TypeIds::TrCycle, {fixture.params[3]});
+                    writer.color(pulse, dmx);
+                    writer.color(source, pulse);
+                    writer.trigger(cycle, pulse);
+                    setup.push_back(fixture);
+                }
+            }
+            Engine engine;
+            engine.build(writer.bytes());
+
+            auto expected = [&](const size_t i, const uint32_t tick) {
+                const auto& [color, params] = setup[i];
+                if (effect == TypeIds::FxBreathe) return breatheFloat(color, tick, params[0], params[1], params[2]);
+                // Retriggered on every cycle, so the phase is the time since the last cycle start
+                return pulseFloat(color, tick % params[3], params[0], params[1], params[2]);
+            };
+            auto fixed = [&](const size_t i, const uint32_t tick) {
+                const auto& [color, params] = setup[i];
+                if (effect == TypeIds::FxBreathe) return breatheFixed(color, tick, params[0], params[1], params[2]);
+                return pulseFixed(color, tick % params[3], params[0], params[1], params[2]);
+            };
+
+            int max_error = 0;
+            for (int tick = 0; tick < ticks; tick++) {
+                const auto frame = engine.tick();
+                for (int i = 0; i < fixtures; i++) {
+                    const Color actual = {frame[1 + i * 3], frame[2 + i * 3], frame[3 + i * 3]};
+                    max_error          = std::max(max_error, maxChannelError(actual, expected(i, tick)));
+                }
+            }
+
+            results.push_back(
+                {TreeWriter::config(effect).name.data(),
+                 nanosecondsPerCall(fixtures, ticks, expected),
+                 nanosecondsPerCall(fixtures, ticks, fixed),
+                 max_error});
+        }
+        return results;
+    }
+
+    struct TriggerResult {
+        double    push_ns;        // Queueing a trigger on the producer thread
+        double    latency_us;     // From the push until the tick that renders it returns
+        double    latency_max_us;
+        double    period_us;      // Time between tick starts
+        TickStats ticks;
+    };
+
+    /**
+     * @class LatencySink
+     * @brief Times triggers pushed by another thread until the frame shows them, one trigger at a time.
+     */
+    class LatencySink final : public FrameSink {
+        using Clock = TickDriver::Clock;
+
+        uint8_t last = 0;
+
+    public:
+        std::atomic<Clock::rep> pushed_at        = 0; // Time of the trigger not rendered yet, 0 if there is none
+        double                  latency_total_us = 0;
+        double                  latency_max_us   = 0;
+
+        void write(uint64_t, const std::span<const uint8_t> universes) override
+        {
+            if (universes[1] == last) return;
+            last = universes[1];
+
+            const auto latency = std::chrono::duration<double, std::micro>(
+                                     Clock::now() - Clock::time_point(Clock::duration(pushed_at.load())))
+                                     .count();
+            latency_total_us += latency;
+            latency_max_us = std::max(latency_max_us, latency);
+            pushed_at.store(0, std::memory_order_release);
+        }
+    };
+
+    /**
+     * @brief Push external triggers from another thread at random points between ticks of a \c TickDriver and time
+     * each until the frame shows it, both threads sleep so the result holds on a single core.
+     */
+    TriggerResult measureTriggerLatency(const int samples)
+    {
+        using Clock           = TickDriver::Clock;
+        constexpr auto period = std::chrono::microseconds(1000);
+
+        TreeWriter writer;
+        const auto dmx     = writer.node(TypeIds::DsDmxRgb, {1});
+        const auto black   = writer.node(TypeIds::SrColor, {0, 0, 0});
+        const auto white   = writer.node(TypeIds::SrColor, {0xFF, 0xFF, 0xFF});
+        const auto toggle  = writer.node(TypeIds::MxSwitch, {0});
+        const auto trigger = writer.node(TypeIds::SrTrigger, {1});
+        writer.color(toggle, dmx);
+        writer.color(black, toggle);
+        writer.color(white, toggle);
+        writer.trigger(trigger, toggle);
+
+        Engine engine;
+        engine.build(writer.bytes());
+        LatencySink sink;
+        TickDriver  driver(engine, sink, period);
+
+        Clock::duration push_time{};
+        std::thread     producer([&] {
+            Random random(samples);
+            for (int i = 0; i < samples; i++) {
+                std::this_thread::sleep_for(std::chrono::microseconds(randomParam(random, 0, period.count())));
+
+                const auto start = Clock::now();
+                sink.pushed_at.store(start.time_since_epoch().count(), std::memory_order_release);
+                engine.triggerExternalTrigger(1);
+                push_time += Clock::now() - start;
+
+                while (sink.pushed_at.load(std::memory_order_acquire) != 0)
+                    std::this_thread::sleep_for(std::chrono::microseconds(10));
+            }
+            driver.stop();
+        });
+        driver.run();
+        producer.join();
+
+        return {
+            std::chrono::duration<double, std::nano>(push_time).count() / samples,
+            sink.latency_total_us / samples,
+            sink.latency_max_us,
+            std::chrono::duration<double, std::micro>(period).count(),
+            driver.getStats()};
+    }
+
+    struct RingResult {
+        size_t    slots;
+        TickStats ticks;
+    };
+
+    /**
+     * @brief Render into a \c FrameRing on another thread that stalls for three periods now and then, as a build or a
+     * busy core would, while a \c TickDriver sends frames on time.
+     */
+    std::vector<RingResult> measureFrameRing(const int frames)
+    {
+        constexpr auto period = std::chrono::microseconds(1000);
+
+        Random     random(frames);
+        TreeWriter writer;
+        deepTree(writer, random, 200);
+        Engine engine;
+        engine.build(writer.bytes());
+
+        std::vector<RingResult> results;
+        for (const size_t slots : {1, 8}) {
+            FrameRing         ring(DMX_PACKET_SIZE, slots);
+            MemoryFrameSink   sink;
+            TickDriver        driver(ring, sink, period);
+            std::atomic<bool> done = false;
+
+            engine.renderAhead(ring); // Driver starts right away, so the first frame is there
+            std::thread renderer([&] {
+                Random stalls(slots);
+                while (!done.load(std::memory_order_relaxed)) {
+                    if (engine.renderAhead(ring) == 0) std::this_thread::sleep_for(period / 4);
+                    else if (stalls() % 40 == 0) std::this_thread::sleep_for(period * 3);
+                }
+            });
+            driver.run(frames);
+            done.store(true, std::memory_order_relaxed);
+            renderer.join();
+            results.push_back({slots, driver.getStats()});
+        }
+        return results;
+    }
+
+    struct FanOutResult {
+        int    fan_out;
+        int    depth;
+        double tick_ns;
+    };
+
+    /**
+     * @brief One breathing effect behind a chain of adds, fanned out to DMX fixtures from a single output.
+     * @param fan_out Number of DMX fixtures reading the effect
+     * @param depth Number of adds between the color source and the effect
+     */
+    std::vector<uint8_t> fanOutTree(const int fan_out, const int depth)
+    {
+        TreeWriter writer;
+        auto       source = writer.node(TypeIds::SrColor, {0x20, 0x10, 0x08});
+        for (int i = 0; i < depth; i++) {
+            const auto add   = writer.node(TypeIds::MxAdd);
+            const auto color = writer.node(TypeIds::SrColor, {0x01, 0x01, 0x01});
+            writer.color(source, add);
+            writer.color(color, add);
+            source = add;
+        }
+        const auto breathe = writer.node(TypeIds::FxBreathe, {400, 0, 0xFF});
+        writer.color(source, breathe);
+
+        uint16_t dmx = 0;
+        for (int i = 0; i < fan_out; i++) {
+            if (i % MAXIMUM_CONNECTIONS == 0)
+                dmx = writer.node(TypeIds::DsDmxRgb, {static_cast<uint16_t>(1 + i * 3 % 510)});
+            writer.color(breathe, dmx);
+        }
+        return writer.bytes();
+    }
+
+    /**
+     * @brief Time ticks of one output read by a growing number of links, behind chains of growing depth.
+     */
+    std::vector<FanOutResult> measureFanOut(const int ticks)
+    {
+        std::vector<FanOutResult> results;
+        for (const auto fan_out : {1, 8, MAXIMUM_CONNECTIONS}) {
+            for (const auto depth : {1, 16, 64}) {
+                Engine engine;
+                engine.build(fanOutTree(fan_out, depth));
+                const auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < ticks; i++)
+                    sink = engine.tick()[1];
+                const auto end = std::chrono::steady_clock::now();
+                results.push_back(
+                    {fan_out, depth, std::chrono::duration<double, std::nano>(end - start).count() / ticks});
+            }
+        }
+        return results;
+    }
+
+    struct RandomResult {
+        double mt19937_ns;   // Shared std::mt19937 with a distribution built per call, as nodes used before
+        double generator_ns; // RandomGenerator of the engine
+    };
+
+    /**
+     * @brief Time random integers in the ranges nodes draw from, small input indexes and chance thresholds.
+     */
+    RandomResult measureRandom(const int calls)
+    {
+        const auto before = [](const int from, const int to) {
+            if (from >= to) return from;
+            static std::mt19937           mersenne_twister_engine(std::random_device{}());
+            std::uniform_int_distribution distribution(from, to);
+            return distribution(mersenne_twister_engine);
+        };
+        RandomGenerator generator(calls);
+        const auto      after = [&](const int from, const int to) { return generator.between(from, to); };
+
+        const auto time = [&](auto draw) {
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < calls; i++)
+                sink = draw(0, i & 1 ? 3 : PARAM_MAX_VALUE - 1);
+            const auto end = std::chrono::steady_clock::now();
+            return std::chrono::duration<double, std::nano>(end - start).count() / calls;
+        };
+        return {time(before), time(after)};
+    }
+
+    /**
+     * @class DiscardSink
+     * @brief Reads one byte of every frame and drops it, so farm results measure ticking only.
+     */
+    class DiscardSink final : public FrameSink {
+    public:
+        volatile uint8_t last = 0;
+
+        void write(uint64_t, const std::span<const uint8_t> universes) override { last = universes[1]; }
+    };
+
+    /**
+     * @brief Tick 64 engines running the all types shape on one thread and on every hardware thread.
+     */
+    std::vector<FarmStats> measureFarm(const int nodes_count, const int frames)
+    {
+        constexpr size_t engines_count = 64;
+
+        Random     random(nodes_count);
+        TreeWriter writer;
+        allTypesTree(writer, random, nodes_count);
+        const auto tree = writer.bytes();
+
+        std::vector<FarmStats> results;
+        for (const auto threads : {1u, std::max(1u, std::thread::hardware_concurrency())}) {
+            if (!results.empty() && threads == results.back().threads) break;
+            std::vector<std::unique_ptr<Engine>> engines;
+            std::vector<DiscardSink>             sinks(engines_count);
+            EngineFarm                           farm(threads);
+            for (size_t i = 0; i < engines_count; i++) {
+                engines.push_back(std::make_unique<Engine>());
+                engines.back()->setSeed(i);
+                engines.back()->build(tree);
+                farm.add(*engines.back(), sinks[i], frames);
+            }
+            results.push_back(farm.run());
+        }
+        return results;
+    }
+
+    void printJson(
+        const std::vector<Result>&       results,
+        const std::vector<FanOutResult>& fan_outs,
+        const std::vector<MathResult>&   math,
+        const TriggerResult&             trigger,
+        const std::vector<RingResult>&   rings,
+        const RandomResult&              random,
+        const std::vector<FarmStats>&    farms,
+        const int                        nodes_count,
+        const int                        ticks)
+    {
+        std::cout << "{\"tree_version\":" << static_cast<int>(TREE_VERSION) << ",\"nodes\":" << nodes_count
+                  << ",\"ticks\":" << ticks << ",\"results\":[";
+        for (size_t i = 0; i < results.size(); i++) {
+            const auto& result = results[i];
+            std::cout << (i == 0 ? "" : ",") << "{\"shape\":\"" << result.shape << "\",\"nodes\":" << result.nodes
+                      << ",\"dead_nodes\":" << result.dead_nodes << ",\"links\":" << result.links
+                      << ",\"bytes\":" << result.bytes << ",\"compact_bytes\":" << result.compact_bytes
+                      << ",\"build_us\":" << result.build_us
+                      << ",\"compact_build_us\":" << result.compact_build_us
+                      << ",\"build_allocations\":" << result.build_allocations
+                      << ",\"rebuild_allocations\":" << result.rebuild_allocations
+                      << ",\"tick_ns\":" << result.tick_ns << ",\"tick_allocations\":" << result.tick_allocations
+                      << ",\"seek_ns\":" << result.seek_ns << ",\"state_bytes\":" << result.state_bytes
+                      << ",\"restore_us\":" << result.restore_us;
+            if (!result.profile.empty()) {
+                std::cout << ",\"profile\":[";
+                for (size_t j = 0; j < result.profile.size(); j++) {
+                    const auto& [p_config, evaluations, nanoseconds] = result.profile[j];
+                    std::cout << (j == 0 ? "" : ",") << "{\"type\":\"" << p_config->name.data()
+                              << "\",\"evaluations\":" << evaluations << ",\"nanoseconds\":" << nanoseconds << "}";
+                }
+                std::cout << "]";
+            }
+            std::cout << "}";
+        }
+        std::cout << "],\"fan_out\":[";
+        for (size_t i = 0; i < fan_outs.size(); i++) {
+            const auto& [fan_out, depth, tick_ns] = fan_outs[i];
+            std::cout << (i == 0 ? "" : ",") << "{\"fan_out\":" << fan_out << ",\"depth\":" << depth
+                      << ",\"tick_ns\":" << tick_ns << "}";
+        }
+        std::cout << "],\"math\":[";
+        for (size_t i = 0; i < math.size(); i++) {
+            const auto& [effect, float_ns, fixed_ns, max_error] = math[i];
+            std::cout << (i == 0 ? "" : ",") << "{\"effect\":\"" << effect << "\",\"float_ns\":" << float_ns
+                      << ",\"fixed_ns\":" << fixed_ns << ",\"max_error\":" << max_error << "}";
+        }
+        std::cout << "],\"trigger\":{\"push_ns\":" << trigger.push_ns << ",\"latency_us\":" << trigger.latency_us
+                  << ",\"latency_max_us\":" << trigger.latency_max_us << ",\"period_us\":" << trigger.period_us
+                  << ",\"frames\":" << trigger.ticks.frames << ",\"missed\":" << trigger.ticks.missed
+                  << ",\"jitter_mean_ns\":"
+                  << trigger.ticks.jitter_total_ns / std::max<int64_t>(trigger.ticks.frames, 1)
+                  << ",\"jitter_max_ns\":" << trigger.ticks.jitter_max_ns << "},\"ring\":[";
+        for (size_t i = 0; i < rings.size(); i++) {
+            const auto& [slots, ring_ticks] = rings[i];
+            std::cout << (i == 0 ? "" : ",") << "{\"slots\":" << slots << ",\"frames\":" << ring_ticks.frames
+                      << ",\"underruns\":" << ring_ticks.underruns << ",\"missed\":" << ring_ticks.missed << "}";
+        }
+        std::cout << "],\"random\":{\"mt19937_ns\":" << random.mt19937_ns
+                  << ",\"generator_ns\":" << random.generator_ns << "},\"farm\":[";
+        for (size_t i = 0; i < farms.size(); i++) {
+            const auto& farm = farms[i];
+            std::cout << (i == 0 ? "" : ",") << "{\"threads\":" << farm.threads << ",\"frames\":" << farm.frames
+                      << ",\"frames_per_second\":" << farm.frames_per_second << ",\"steals\":" << farm.steals
+                      << "}";
+        }
+        std::cout << "]}\n";
+    }
+
+    void printText(
+        const std::vector<Result>&       results,
+        const std::vector<FanOutResult>& fan_outs,
+        const std::vector<MathResult>&   math,
+        const TriggerResult&             trigger,
+        const std::vector<RingResult>&   rings,
+        const RandomResult&              random,
+        const std::vector<FarmStats>&    farms,
+        const int                        ticks)
+    {
+        std::cout << "SparkWeaverCore benchmark, " << ticks << " ticks\n\n";
+        for (const auto& result : results) {
+            std::cout << result.shape << ": " << result.nodes << " nodes (" << result.dead_nodes << " dead), "
+                      << result.links << " links, " << result.bytes << " bytes, compact " << result.compact_bytes
+                      << " bytes\n"
+                      << "  build " << result.build_us << " us, " << result.build_allocations
+                      << " allocations, rebuild " << result.rebuild_allocations << " allocations, compact build "
+                      << result.compact_build_us << " us\n"
+                      << "  tick " << result.tick_ns << " ns, " << result.tick_allocations << " allocations, seek "
+                      << result.seek_ns << " ns per tick\n"
+                      << "  state " << result.state_bytes << " bytes, restore " << result.restore_us << " us\n";
+            for (const auto& [p_config, evaluations, nanoseconds] : result.profile)
+                std::cout << "    " << p_config->name.data() << ": " << evaluations << " evaluations, "
+                          << static_cast<double>(nanoseconds) / std::max<uint64_t>(evaluations, 1) << " ns each\n";
+        }
+        std::cout << "\nFan out\n\n";
+        for (const auto& [fan_out, depth, tick_ns] : fan_outs)
+            std::cout << "fan_out " << fan_out << " depth " << depth << ": " << tick_ns << " ns/tick\n";
+
+        std::cout << "\nEffect math\n\n";
+        for (const auto& [effect, float_ns, fixed_ns, max_error] : math)
+            std::cout << effect << ": float " << float_ns << " ns, fixed " << fixed_ns << " ns, max error "
+                      << max_error << "\n";
+
+        std::cout << "\nExternal triggers\n\n"
+                  << "push " << trigger.push_ns << " ns, trigger to frame " << trigger.latency_us << " us, max "
+                  << trigger.latency_max_us << " us with ticks every " << trigger.period_us << " us\n"
+                  << "driver " << trigger.ticks.frames << " frames, " << trigger.ticks.missed << " missed, jitter "
+                  << trigger.ticks.jitter_total_ns / std::max<int64_t>(trigger.ticks.frames, 1) << " ns, max "
+                  << trigger.ticks.jitter_max_ns << " ns\n";
+
+        std::cout << "\nFrame ring, renderer stalling for 3 periods\n\n";
+        for (const auto& [slots, ring_ticks] : rings)
+            std::cout << slots << " slots: " << ring_ticks.frames << " frames, " << ring_ticks.underruns
+                      << " underruns, " << ring_ticks.missed << " missed\n";
+
+        std::cout << "\nRandom numbers\n\n"
+                  << "mt19937 " << random.mt19937_ns << " ns, generator " << random.generator_ns << " ns\n";
+
+        std::cout << "\nEngine farm, 64 engines\n\n";
+        for (const auto& farm : farms)
+            std::cout << farm.threads << " threads: " << farm.frames << " frames, " << farm.frames_per_second
+                      << " frames/s, " << farm.frames_per_second / farms[0].frames_per_second << "x, " << farm.steals
+                      << " steals\n";
+    }
+}
+
+/**
+ * Usage: sparkweaver_core_bench [--json] [--nodes N] [--ticks N] [--builds N] [--shape NAME]
+ */
+int main(const int argc, const char* argv[])
+{
+    constexpr Shape shapes[] = {
+        {"wide", wideTree},
+        {"deep", deepTree},
+        {"trigger", triggerTree},
+        {"random", randomTree},
+        {"sparse", sparseTree},
+        {"mixed", mixedTree},
+        {"all_types", allTypesTree},
+    };
+
+    auto             json        = false;
+    auto             nodes_count = 2000;
+    auto             ticks       = 10000;
+    auto             builds      = 10;
+    std::string_view only_shape;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        if (arg == "--json") {
+            json = true;
+        } else if (i + 1 < argc && arg == "--nodes") {
+            nodes_count = std::clamp(std::atoi(argv[++i]), 1, UINT16_MAX);
+        } else if (i + 1 < argc && arg == "--ticks") {
+            ticks = std::max(1, std::atoi(argv[++i]));
+        } else if (i + 1 < argc && arg == "--builds") {
+            builds = std::max(1, std::atoi(argv[++i]));
+        } else if (i + 1 < argc && arg == "--shape") {
+            only_shape = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--json] [--nodes N] [--ticks N] [--builds N] [--shape NAME]\n";
+            return 1;
+        }
+    }
+
+    std::vector<Result> results;
+    for (const auto& shape : shapes)
+        if (only_shape.empty() || only_shape == shape.name)
+            results.push_back(measure(shape, nodes_count, ticks, builds));
+
+    const auto fan_outs = measureFanOut(ticks);
+    const auto math     = measureMath(std::min(ticks, 2000));
+    const auto trigger  = measureTriggerLatency(std::min(ticks, 500));
+    const auto rings    = measureFrameRing(std::min(ticks, 500));
+    const auto random   = measureRandom(ticks * 100);
+    const auto farms    = measureFarm(std::min(nodes_count, 500), std::min(ticks, 2000));
+
+    if (json) printJson(results, fan_outs, math, trigger, rings, random, farms, nodes_count, ticks);
+    else printText(results, fan_outs, math, trigger, rings, random, farms, ticks);
+    return 0;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <iostream>
+
+/**
+ * @brief Minimal assertions for the test executables, failures are counted and printed but do not stop the test.
+ */
+namespace Check {
+    inline int failures = 0;
+
+    inline bool check(const bool condition, const char* expression, const char* file, const int line)
+    {
+        if (!condition) {
+            failures++;
+            std::cerr << file << ":" << line << ": check failed: " << expression << "\n";
+        }
+        return condition;
+    }
+
+    /**
+     * @return Exit code of the test executable
+     */
+    inline int result()
+    {
+        if (failures > 0) std::cerr << failures << " checks failed\n";
+        return failures == 0 ? 0 : 1;
+    }
+}
+
+#define CHECK(condition) Check::check(static_cast<bool>(condition), #condition, __FILE__, __LINE__)
@@ -0,0 +1,66 @@
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <SparkWeaverCore.h>
+
+#include "check.h"
+
+using namespace SparkWeaverCore;
+
+namespace {
+    Color randomColor(std::mt19937& random, const int max)
+    {
+        std::uniform_int_distribution byte(0, max);
+        const auto r = static_cast<uint8_t>(byte(random));
+        const auto g = static_cast<uint8_t>(byte(random));
+        const auto b = static_cast<uint8_t>(byte(random));
+        return {r, g, b};
+    }
+
+    /**
+     * @brief Batch reductions against the scalar operators for every list length up to the input limit, with small
+     * values that rarely saturate and full range values that mostly do.
+     */
+    void checkReductions()
+    {
+        std::mt19937 random(1);
+        for (int round = 0; round < 2000; round++) {
+            for (const auto max : {0x10, 0xFF}) {
+                std::vector<Color> colors;
+                for (int count = 0; count <= MAXIMUM_CONNECTIONS; count++) {
+                    auto sum        = Colors::BLACK;
+                    auto difference = colors.empty() ? Colors::BLACK : colors[0];
+                    for (size_t i = 0; i < colors.size(); i++) {
+                        sum = sum + colors[i];
+                        if (i > 0) difference = difference - colors[i];
+                    }
+                    CHECK(sumColors(colors) == sum);
+                    CHECK(differenceColors(colors) == difference);
+                    colors.push_back(randomColor(random, max));
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Kernels read only the colors of the span, not the bytes after it.
+     */
+    void checkSubspans()
+    {
+        std::vector<Color> colors(MAXIMUM_CONNECTIONS + 8, Colors::WHITE);
+        for (size_t count = 0; count <= MAXIMUM_CONNECTIONS; count++) {
+            std::ranges::fill(colors, Colors::WHITE);
+            std::fill_n(colors.begin(), count, Color{1, 2, 3});
+            const auto sum = sumColors(std::span<const Color>(colors).first(count));
+            CHECK(sum == Color(std::min<size_t>(count, 0xFF), std::min<size_t>(2 * count, 0xFF), 3 * count));
+        }
+    }
+}
+
+int main()
+{
+    checkReductions();
+    checkSubspans();
+    return Check::result();
+}
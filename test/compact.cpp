@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+#include <SparkWeaverCore.h>
+
+#include "check.h"
+#include "trees.h"
+
+using namespace Trees;
+
+namespace {
+    constexpr int TREES = 20;
+    constexpr int TICKS = 500;
+
+    using Generator = std::function<void(TreeWriter&, Random&, int)>;
+
+    const std::vector<Generator> generators = {
+        wideTree, deepTree, triggerTree, randomTree, sparseTree, mixedTree, allTypesTree};
+
+    void buildSeeded(Engine& engine, const std::span<const uint8_t> tree, const int seed)
+    {
+        engine.setSeed(seed);
+        engine.build(tree);
+    }
+
+    bool sameFrames(Engine& engine, Engine& reference, const int ticks)
+    {
+        for (int i = 0; i < ticks; i++)
+            if (!std::ranges::equal(engine.tickUniverses(), reference.tickUniverses())) return false;
+        return true;
+    }
+
+    bool rejected(const std::vector<uint8_t>& tree)
+    {
+        Engine engine;
+        try {
+            engine.build(tree);
+        } catch (const std::exception&) {
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Exported trees, with and without the evaluation order, build the same show and export the same bytes.
+     */
+    void checkRoundTrip(const Generator& generator)
+    {
+        for (int seed = 0; seed < TREES; seed++) {
+            Random     random(seed);
+            TreeWriter writer;
+            generator(writer, random, 90);
+            const auto tree = writer.bytes();
+            Engine     reference;
+            buildSeeded(reference, tree, seed);
+            const auto exported = reference.exportTree();
+            CHECK(exported.front() == COMPACT_TREE_VERSION);
+            CHECK(exported.size() < tree.size());
+
+            for (const auto with_order : {true, false}) {
+                const auto compact = reference.exportTree(with_order);
+                Engine     engine, plain;
+                buildSeeded(engine, compact, seed);
+                buildSeeded(plain, tree, seed);
+                CHECK(engine.exportTree() == exported);
+                CHECK(engine.getDeadNodeCount() == plain.getDeadNodeCount());
+                CHECK(sameFrames(engine, plain, TICKS));
+            }
+        }
+    }
+
+    /**
+     * @brief Version 04 stores the delay in one byte, the tree equals the one written in the full format.
+     */
+    void checkByteDelay()
+    {
+        // DMX at 50 showing a color strobed by a 60 tick cycle delayed by 200 ticks
+        const std::vector<uint8_t> tree = {
+            0x04,
+            0x05, 0x02, 0x02, 0x00,
+            TypeIds::DsDmxRgb, 0x32,
+            TypeIds::FxStrobe, 0x03,
+            TypeIds::TrDelay, 0xC8,
+            TypeIds::TrCycle, 0x3C, 0x00,
+            TypeIds::SrColor, 0xFF, 0x80, 0x40,
+            0x00, 0x02, 0x00,
+            0x02, 0x06, 0x00,
+            0x00, 0x02, 0x00,
+            0x02, 0x02, 0x00};
+
+        TreeWriter writer;
+        const auto dmx    = writer.node(TypeIds::DsDmxRgb, {50});
+        const auto strobe = writer.node(TypeIds::FxStrobe, {3});
+        const auto delay  = writer.node(TypeIds::TrDelay, {200});
+        const auto cycle  = writer.node(TypeIds::TrCycle, {60, 0});
+        const auto color  = writer.node(TypeIds::SrColor, {0xFF, 0x80, 0x40});
+        writer.color(strobe, dmx);
+        writer.color(color, strobe);
+        writer.trigger(delay, strobe);
+        writer.trigger(cycle, delay);
+
+        Engine engine, reference;
+        engine.build(tree);
+        reference.build(writer.bytes());
+        CHECK(engine.exportTree() == reference.exportTree());
+        CHECK(sameFrames(engine, reference, TICKS));
+
+        // Same delay as a varint is version 05
+        auto compact = tree;
+        compact[0]   = COMPACT_TREE_VERSION;
+        CHECK(rejected(compact));
+        compact.insert(compact.begin() + 11, 0x01);
+        compact[10] = 0xC8;
+        Engine current;
+        current.build(compact);
+        CHECK(current.exportTree() == reference.exportTree());
+    }
+
+    /**
+     * @brief Varints over 32 bits or cut off by the end of the tree are rejected.
+     */
+    void checkVarints()
+    {
+        const std::vector<uint8_t> example = {0x05, 0x02, 0x01, 0x00, 0x00, 0x00, 0x32, 0x60, 0xFF, 0x80, 0x40, 0x00,
+                                              0x02, 0x00};
+        CHECK(!rejected(example));
+        CHECK(rejected({0x05, 0xFF, 0xFF, 0xFF, 0xFF, 0x1F, 0x01, 0x00, 0x00}));
+        CHECK(rejected({0x05, 0x82, 0x80, 0x80, 0x80, 0x10, 0x01, 0x00, 0x00}));
+        for (size_t size = 1; size < example.size(); size++)
+            CHECK(rejected({example.begin(), example.begin() + size}));
+
+        // Address 512 as a varint, the last link index cut off after a continuation byte
+        CHECK(!rejected({0x05, 0x02, 0x01, 0x00, 0x00, 0x00, 0x80, 0x04, 0x60, 0xFF, 0x80, 0x40, 0x00, 0x02, 0x00}));
+        CHECK(rejected({0x05, 0x02, 0x01, 0x00, 0x00, 0x00, 0x32, 0x60, 0xFF, 0x80, 0x40, 0x00, 0x02, 0x80}));
+    }
+}
+
+int main()
+{
+    for (const auto& generator : generators)
+        checkRoundTrip(generator);
+    checkByteDelay();
+    checkVarints();
+    return Check::result();
+}
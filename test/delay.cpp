@@ -0,0 +1,131 @@
+#include <cstdint>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include <SparkWeaverCore.h>
+
+#include "check.h"
+#include "trees.h"
+
+using namespace Trees;
+
+namespace {
+    constexpr uint16_t DELAY_NODE = 4;
+
+    /**
+     * @brief White one tick flash on every trigger of an interval trigger, passed through a delay unless it is 0.
+     */
+    std::vector<uint8_t> strobeTree(const uint16_t cycle, const uint16_t phase, const uint16_t delay)
+    {
+        TreeWriter writer;
+        const auto color  = writer.node(TypeIds::SrColor, {0xFF, 0xFF, 0xFF});
+        const auto source = writer.node(TypeIds::TrCycle, {cycle, phase});
+        const auto strobe = writer.node(TypeIds::FxStrobe);
+        const auto dmx    = writer.node(TypeIds::DsDmxRgb, {1});
+        std::ignore       = writer.color(color, strobe);
+        std::ignore       = writer.color(strobe, dmx);
+        if (delay == 0) {
+            std::ignore = writer.trigger(source, strobe);
+        } else {
+            const auto delayed = writer.node(TypeIds::TrDelay, {delay});
+            std::ignore        = writer.trigger(source, delayed);
+            std::ignore        = writer.trigger(delayed, strobe);
+        }
+        return writer.bytes();
+    }
+
+    /**
+     * @brief Interval trigger that fires at the ticks a delayed one does once the first trigger came through.
+     */
+    std::vector<uint8_t> shiftedTree(const uint16_t cycle, const uint32_t delay)
+    {
+        return strobeTree(cycle, (cycle - delay % cycle) % cycle, 0);
+    }
+
+    bool isLit(Engine& engine) { return engine.tick()[1] != 0; }
+
+    /**
+     * @brief Every trigger comes out of the delay at its own tick, however many are on their way.
+     */
+    void checkDelayTiming(const uint16_t cycle, const uint16_t delay, const uint32_t ticks)
+    {
+        Engine engine, reference;
+        engine.build(strobeTree(cycle, 0, delay));
+        reference.build(shiftedTree(cycle, delay));
+
+        auto dark = true;
+        for (uint32_t tick = 0; tick < delay; tick++)
+            dark = !isLit(engine) && dark;
+        CHECK(dark);
+
+        reference.seek(delay);
+
+        auto same = true;
+        for (uint32_t tick = delay; tick < delay + ticks; tick++)
+            same = isLit(engine) == isLit(reference) && same;
+        CHECK(same);
+    }
+
+    /**
+     * @brief A new delay drops the triggers on their way, as a rebuilt tree would.
+     */
+    void checkDelayChange(const uint16_t cycle, const uint16_t delay, const uint16_t next_delay)
+    {
+        Engine engine, reference;
+        engine.build(strobeTree(cycle, 0, delay));
+        reference.build(shiftedTree(cycle, next_delay));
+        for (uint32_t tick = 0; tick < 2u * delay; tick++)
+            std::ignore = engine.tick();
+        CHECK(engine.setParam(DELAY_NODE, 0, next_delay));
+
+        auto dark = true;
+        for (uint32_t tick = 0; tick < next_delay; tick++)
+            dark = !isLit(engine) && dark;
+        CHECK(dark);
+
+        reference.seek(engine.getTick());
+        auto same = true;
+        for (uint32_t tick = 0; tick < 2u * next_delay; tick++)
+            same = isLit(engine) == isLit(reference) && same;
+        CHECK(same);
+    }
+
+    /**
+     * @brief Triggers on their way are saved with the state and fire after loading it.
+     */
+    void checkStateRoundTrip(const uint16_t cycle, const uint16_t delay)
+    {
+        const auto tree = strobeTree(cycle, 0, delay);
+        Engine     engine, loaded;
+        engine.build(tree);
+        loaded.build(tree);
+        for (uint32_t tick = 0; tick < delay + delay / 2u; tick++)
+            std::ignore = engine.tick();
+        loaded.restoreState(engine.saveState());
+
+        auto same = true;
+        for (uint32_t tick = 0; tick < 2u * delay; tick++)
+            same = isLit(engine) == isLit(loaded) && same;
+        CHECK(same);
+        CHECK(engine.saveState() == loaded.saveState());
+    }
+}
+
+int main()
+{
+    checkDelayTiming(2, 100, 600);
+    checkDelayTiming(1, 300, 600);
+    checkDelayTiming(3, 64, 300);
+    checkDelayTiming(7, 1000, 3000);
+    checkDelayTiming(1, PARAM_MAX_VALUE, 1000);
+    Random random(1);
+    for (int i = 0; i < 40; i++)
+        checkDelayTiming(randomParam(random, 1, 40), randomParam(random, 33, 3000), 2000);
+
+    checkDelayChange(2, 100, 40);
+    checkDelayChange(3, 40, 300);
+    checkStateRoundTrip(2, 100);
+    checkStateRoundTrip(1, 500);
+    return Check::result();
+}
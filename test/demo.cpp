@@ -39,28 +39,29 @@ int main()
 
     std::cout << "\n\nSMOKE TEST\n\nexpected FF 80 40 00\nresult   ";
     try {
+        const std::vector<uint8_t> tree = {
+            SparkWeaverCore::TREE_VERSION,
+            SparkWeaverCore::TypeIds::DsDmxRgb,
+            0x01,
+            0x00,
+            SparkWeaverCore::TypeIds::SrColor,
+            0xFF,
+            0x00,
+            0x80,
+            0x00,
+            0x40,
+            0x00,
+            SparkWeaverCore::CommandIds::ColorLinks,
+            0x01,
+            0x00,
+            0x01,
+            0x00,
+            0x00,
+            0x00,
+            0x00,
+            0x00};
         SparkWeaverCore::Engine engine;
-        engine.build(
-            {SparkWeaverCore::TREE_VERSION,
-             SparkWeaverCore::TypeIds::DsDmxRgb,
-             0x01,
-             0x00,
-             SparkWeaverCore::TypeIds::SrColor,
-             0xFF,
-             0x00,
-             0x80,
-             0x00,
-             0x40,
-             0x00,
-             SparkWeaverCore::CommandIds::ColorLinks,
-             0x01,
-             0x00,
-             0x01,
-             0x00,
-             0x00,
-             0x00,
-             0x00,
-             0x00});
+        engine.build(tree);
         const auto data = engine.tick();
         std::cout << std::format("{:02X} {:02X} {:02X} {:02X}\n", data[1], data[2], data[3], data[4]);
     } catch (const std::exception& e) {
@@ -0,0 +1,76 @@
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include <SparkWeaverCore.h>
+
+#include "check.h"
+#include "trees.h"
+
+using namespace Trees;
+
+namespace {
+    using Clock = TickDriver::Clock;
+
+    constexpr auto     PERIOD        = std::chrono::milliseconds(20);
+    constexpr auto     TOLERANCE     = PERIOD / 4;
+    constexpr auto     OVERRUN       = PERIOD * 3 / 2; // Ends half way between two deadlines
+    constexpr uint64_t OVERRUN_FRAME = 3;
+    constexpr uint64_t FRAMES        = 10;
+
+    /**
+     * @class TimingSink
+     * @brief Records when every frame arrives, one frame takes longer than the period.
+     */
+    class TimingSink final : public FrameSink {
+    public:
+        std::vector<Clock::time_point> times{};
+
+        void write(const uint64_t frame, std::span<const uint8_t>) override
+        {
+            times.push_back(Clock::now());
+            if (frame == OVERRUN_FRAME) std::this_thread::sleep_for(OVERRUN);
+        }
+    };
+
+    /**
+     * @brief After a frame runs past the next deadline, the missed deadline is skipped and the following frames start
+     * on the grid of the first frame again instead of one period after the slow frame.
+     */
+    void checkOverrunKeepsGrid()
+    {
+        TreeWriter writer;
+        const auto color = writer.node(TypeIds::SrColor, {0xFF, 0xFF, 0xFF});
+        const auto dmx   = writer.node(TypeIds::DsDmxRgb, {1});
+        std::ignore      = writer.color(color, dmx);
+        Engine engine;
+        engine.build(writer.bytes());
+
+        TimingSink sink;
+        TickDriver driver(engine, sink, PERIOD);
+        driver.run(FRAMES);
+
+        const auto& stats = driver.getStats();
+        CHECK(stats.frames == FRAMES);
+        CHECK(stats.missed == 1);
+        CHECK(sink.times.size() == FRAMES);
+        if (sink.times.size() != FRAMES) return;
+
+        // Frames after the slow one are one deadline later than their number
+        auto on_grid = true;
+        for (uint64_t frame = 1; frame < FRAMES; frame++) {
+            const auto deadline = sink.times[0] + PERIOD * (frame > OVERRUN_FRAME ? frame + 1 : frame);
+            on_grid             = sink.times[frame] >= deadline - TOLERANCE && on_grid;
+            on_grid             = sink.times[frame] < deadline + TOLERANCE && on_grid;
+        }
+        CHECK(on_grid);
+    }
+}
+
+int main()
+{
+    checkOverrunKeepsGrid();
+    return Check::result();
+}
@@ -0,0 +1,171 @@
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <SparkWeaverCore.h>
+
+#include "check.h"
+#include "trees.h"
+
+using namespace Trees;
+
+namespace {
+    constexpr uint64_t FRAMES = 1000;
+
+    std::vector<uint8_t> generateTree(const int seed)
+    {
+        Random     random(seed);
+        TreeWriter writer;
+        mixedTree(writer, random, 40);
+        return writer.bytes();
+    }
+
+    void buildSeeded(Engine& engine, const std::span<const uint8_t> tree, const int seed)
+    {
+        engine.setSeed(seed);
+        engine.build(tree);
+    }
+
+    /**
+     * @brief Frames an engine renders when ticked on its own.
+     */
+    std::vector<std::vector<uint8_t>> referenceFrames(const int seed, const uint64_t frames)
+    {
+        Engine engine;
+        buildSeeded(engine, generateTree(seed), seed);
+        std::vector<std::vector<uint8_t>> result;
+        for (uint64_t i = 0; i < frames; i++) {
+            const auto universes = engine.tickUniverses();
+            result.emplace_back(universes.begin(), universes.end());
+        }
+        return result;
+    }
+
+    /**
+     * @class FailingSink
+     * @brief Throws at a frame once the engine it waits for has written its first frame.
+     */
+    class FailingSink final : public FrameSink {
+        std::atomic<int>& stage; // 1 once the waiting engine ticks, 2 once this sink throws
+        uint64_t          fail_frame;
+
+    public:
+        uint64_t written = 0;
+
+        FailingSink(std::atomic<int>& stage, const uint64_t fail_frame)
+            : stage(stage)
+            , fail_frame(fail_frame)
+        {
+        }
+
+        void write(const uint64_t frame, std::span<const uint8_t>) override
+        {
+            if (frame == fail_frame) {
+                while (stage.load() == 0)
+                    std::this_thread::yield();
+                stage = 2;
+                throw std::runtime_error("sink failed");
+            }
+            written++;
+        }
+    };
+
+    /**
+     * @class WaitingSink
+     * @brief Keeps every frame, the first frame waits until the failing sink has thrown unless it already has.
+     */
+    class WaitingSink final : public FrameSink {
+        std::atomic<int>& stage;
+
+    public:
+        std::vector<std::vector<uint8_t>> frames{};
+        std::vector<uint64_t>             numbers{};
+
+        explicit WaitingSink(std::atomic<int>& stage)
+            : stage(stage)
+        {
+        }
+
+        void write(const uint64_t frame, const std::span<const uint8_t> universes) override
+        {
+            if (auto idle = 0; frame == 0 && stage.compare_exchange_strong(idle, 1)) {
+                while (stage.load() != 2)
+                    std::this_thread::yield();
+            }
+            frames.emplace_back(universes.begin(), universes.end());
+            numbers.push_back(frame);
+        }
+    };
+
+    /**
+     * @brief Every engine gets all its frames in order, the same as ticking it on its own.
+     */
+    void checkFrames()
+    {
+        constexpr int                ENGINES = 12;
+        std::deque<Engine>           engines(ENGINES);
+        std::vector<MemoryFrameSink> sinks(ENGINES);
+        EngineFarm                   farm(4);
+        for (int seed = 0; seed < ENGINES; seed++) {
+            buildSeeded(engines[seed], generateTree(seed), seed);
+            farm.add(engines[seed], sinks[seed], FRAMES + seed);
+        }
+        const auto stats = farm.run();
+
+        uint64_t frames = 0;
+        for (int seed = 0; seed < ENGINES; seed++) {
+            CHECK(sinks[seed].getFrames() == referenceFrames(seed, FRAMES + seed));
+            frames += FRAMES + seed;
+        }
+        CHECK(stats.frames == frames);
+    }
+
+    /**
+     * @brief A failing sink stops only its engine, the healthy engine keeps getting frames after the failure and
+     * the run rethrows once it is done.
+     */
+    void checkFailureIsolated()
+    {
+        for (const auto threads : {1, 2}) {
+            std::atomic<int>   stage{0};
+            FailingSink        failing_sink(stage, 5);
+            WaitingSink        waiting_sink(stage);
+            std::deque<Engine> engines(2);
+            buildSeeded(engines[0], generateTree(0), 0);
+            buildSeeded(engines[1], generateTree(1), 1);
+
+            EngineFarm farm(threads);
+            farm.add(engines[0], failing_sink, FRAMES);
+            farm.add(engines[1], waiting_sink, FRAMES);
+            // A single thread cannot wait for the other engine, the waiting engine runs first and must not wait
+            if (threads == 1) stage = 2;
+
+            auto rethrown = false;
+            try {
+                std::ignore = farm.run();
+            } catch (const std::runtime_error&) {
+                rethrown = true;
+            }
+            CHECK(rethrown);
+            CHECK(failing_sink.written == 5);
+            CHECK(waiting_sink.frames == referenceFrames(1, FRAMES));
+
+            auto in_order = waiting_sink.numbers.size() == FRAMES;
+            for (uint64_t i = 0; in_order && i < FRAMES; i++)
+                in_order = waiting_sink.numbers[i] == i;
+            CHECK(in_order);
+        }
+    }
+}
+
+int main()
+{
+    checkFrames();
+    checkFailureIsolated();
+    return Check::result();
+}
@@ -0,0 +1,94 @@
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <SparkWeaverCore.h>
+
+#include "check.h"
+#include "trees.h"
+
+using namespace Trees;
+
+namespace {
+    constexpr uint16_t COLOR_NODE = 0;
+    constexpr uint16_t STEPS      = 0xFF;
+
+    std::vector<uint8_t> colorTree()
+    {
+        TreeWriter writer;
+        const auto color = writer.node(TypeIds::SrColor, {0, 0, 0});
+        const auto dmx   = writer.node(TypeIds::DsDmxRgb, {1});
+        std::ignore      = writer.color(color, dmx);
+        return writer.bytes();
+    }
+
+    uint8_t red(Engine& engine) { return engine.tick()[1]; }
+
+    /**
+     * @brief Changes made on another thread while ticking arrive in the order they were made, the last one stays.
+     */
+    void checkOtherThread()
+    {
+        Engine engine;
+        engine.build(colorTree());
+
+        std::atomic<bool> done{false};
+        std::jthread      ui([&engine, &done] {
+            for (uint16_t value = 1; value <= STEPS; value++) {
+                while (!engine.setParam(COLOR_NODE, 0, value))
+                    std::this_thread::yield();
+            }
+            done = true;
+        });
+
+        uint8_t last     = 0;
+        auto    in_order = true;
+        while (!done.load()) {
+            const auto value = red(engine);
+            in_order         = value >= last && in_order;
+            last             = value;
+        }
+        ui.join();
+        CHECK(in_order);
+        CHECK(red(engine) == STEPS);
+    }
+
+    /**
+     * @brief Invalid changes are queued but dropped when applied, the valid ones around them still apply.
+     */
+    void checkInvalidDropped()
+    {
+        Engine engine;
+        engine.build(colorTree());
+        CHECK(engine.setParam(COLOR_NODE, 0, 0x40));
+        CHECK(engine.setParam(7, 0, 0x80));
+        CHECK(engine.setParam(COLOR_NODE, 9, 0x80));
+        CHECK(engine.setParam(COLOR_NODE, 1, 0x20));
+        const auto frame = engine.tick();
+        CHECK(frame[1] == 0x40);
+        CHECK(frame[2] == 0x20);
+        CHECK(frame[3] == 0);
+    }
+
+    /**
+     * @brief Changes made for a tree that is replaced do not reach the next tree.
+     */
+    void checkDroppedByBuild()
+    {
+        Engine engine;
+        engine.build(colorTree());
+        CHECK(engine.setParam(COLOR_NODE, 0, 0x40));
+        engine.build(colorTree());
+        CHECK(red(engine) == 0);
+    }
+}
+
+int main()
+{
+    checkOtherThread();
+    checkInvalidDropped();
+    checkDroppedByBuild();
+    return Check::result();
+}
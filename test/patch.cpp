@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <span>
+#include <tuple>
+#include <vector>
+
+#include <SparkWeaverCore.h>
+
+#include "check.h"
+#include "trees.h"
+
+using namespace Trees;
+
+namespace {
+    constexpr size_t    LARGE_ALLOCATION  = 16384; // Arena blocks of a grown tree, larger than any vector of a patch
+    std::atomic<size_t> large_allocations = 0;
+}
+
+void* operator new(const size_t size)
+{
+    if (size >= LARGE_ALLOCATION) large_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (const auto p = std::malloc(size == 0 ? 1 : size)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+    constexpr int TREES = 40;
+    constexpr int TICKS = 300;
+
+    std::vector<uint8_t> generateTree(const int seed, const int nodes_count)
+    {
+        Random     random(seed);
+        TreeWriter writer;
+        allTypesTree(writer, random, nodes_count);
+        return writer.bytes();
+    }
+
+    void buildSeeded(Engine& engine, const std::span<const uint8_t> tree, const int seed)
+    {
+        engine.setSeed(seed);
+        engine.build(tree);
+    }
+
+    bool sameFrame(Engine& engine, Engine& reference)
+    {
+        const auto frame           = engine.tickUniverses();
+        const auto reference_frame = reference.tickUniverses();
+        if (!std::ranges::equal(frame, reference_frame)) return false;
+        for (size_t universe = 0; universe < reference.getUniverseCount(); universe++) {
+            const auto changed           = engine.getChangedChannels(universe);
+            const auto reference_changed = reference.getChangedChannels(universe);
+            if (changed.start != reference_changed.start || changed.end != reference_changed.end) return false;
+        }
+        return true;
+    }
+
+    bool sameFrames(Engine& engine, Engine& reference, const int ticks)
+    {
+        for (int i = 0; i < ticks; i++)
+            if (!sameFrame(engine, reference)) return false;
+        return true;
+    }
+
+    /**
+     * @brief A node nothing reads from changes no frame, changed channels of the next tick included.
+     */
+    void checkUnconnectedNode()
+    {
+        for (int seed = 0; seed < TREES; seed++) {
+            const auto tree = generateTree(seed, 120);
+            Engine     engine, reference;
+            buildSeeded(engine, tree, seed);
+            buildSeeded(reference, tree, seed);
+            CHECK(sameFrames(engine, reference, TICKS));
+
+            const auto p_frame = engine.tick();
+            std::ignore        = reference.tick();
+            const std::vector<uint8_t> frame(p_frame, p_frame + DMX_PACKET_SIZE);
+            const auto                 profiles = engine.getNodeProfiles();
+            engine.applyPatch(std::vector<uint8_t>{
+                PATCH_VERSION, PatchCommandIds::AddNode, TypeIds::SrColor, 0xFF, 0, 0x80, 0, 0x40, 0});
+            CHECK(std::ranges::equal(frame, std::span(p_frame, DMX_PACKET_SIZE)));
+
+            // Profiles are empty unless built with SPARKWEAVER_CORE_PROFILE, counters of existing nodes are kept
+            const auto patched_profiles = engine.getNodeProfiles();
+            CHECK(patched_profiles.size() == (profiles.empty() ? 0 : profiles.size() + 1));
+            for (size_t i = 0; i < profiles.size() && i < patched_profiles.size(); i++)
+                CHECK(patched_profiles[i].evaluations == profiles[i].evaluations);
+            CHECK(sameFrames(engine, reference, TICKS));
+
+            engine.applyPatch(std::vector<uint8_t>{PATCH_VERSION, PatchCommandIds::RemoveNode, 120, 0});
+            CHECK(sameFrames(engine, reference, TICKS));
+            CHECK(engine.exportTree() == reference.exportTree());
+        }
+    }
+
+    /**
+     * @brief A rejected patch leaves the tree, its frames and its state as they were.
+     */
+    void checkRollback()
+    {
+        const std::vector<std::vector<uint8_t>> patches = {
+            // Node added, then a link from an input that is not connected removed
+            {PATCH_VERSION, PatchCommandIds::AddNode, TypeIds::SrColor, 1, 0, 2, 0, 3, 0,
+             PatchCommandIds::RemoveColorLink, 121, 0, 0},
+            // First node removed, then a link to a node index past the end
+            {PATCH_VERSION, PatchCommandIds::RemoveNode, 0, 0, PatchCommandIds::AddColorLink, 0, 0, 200, 0, 0, 0},
+            // Cycle through two added mixers
+            {PATCH_VERSION, PatchCommandIds::AddNode, TypeIds::MxAdd, PatchCommandIds::AddNode, TypeIds::MxAdd,
+             PatchCommandIds::AddColorLink, 120, 0, 121, 0, 0, 0, PatchCommandIds::AddColorLink, 121, 0, 120, 0, 0, 0},
+            // Interval trigger with a cycle length of 0
+            {PATCH_VERSION, PatchCommandIds::AddNode, TypeIds::TrCycle, 0, 0, 0, 0},
+            // Unknown command after a valid one
+            {PATCH_VERSION, PatchCommandIds::AddNode, TypeIds::MxAdd, 0xEE},
+        };
+
+        for (int seed = 0; seed < TREES; seed++) {
+            const auto tree = generateTree(seed, 120);
+            Engine     engine, reference;
+            buildSeeded(engine, tree, seed);
+            buildSeeded(reference, tree, seed);
+            CHECK(sameFrames(engine, reference, TICKS));
+
+            for (const auto& patch : patches) {
+                auto rejected = false;
+                try {
+                    engine.applyPatch(patch);
+                } catch (const std::exception&) {
+                    rejected = true;
+                }
+                CHECK(rejected);
+                CHECK(engine.exportTree() == reference.exportTree());
+                CHECK(engine.saveState() == reference.saveState());
+                CHECK(sameFrames(engine, reference, 20));
+            }
+        }
+    }
+
+    /**
+     * @brief Links removed and added back in one patch leave the frames of the tree that never changed, nodes keep
+     * their state.
+     */
+    void checkRelink()
+    {
+        for (int seed = 0; seed < TREES; seed++) {
+            Random     random(seed);
+            TreeWriter writer;
+            mixedTree(writer, random, 60); // Groups of DMX, add, breathe, pulse, cycle and color
+            const auto tree = writer.bytes();
+            Engine     engine, reference;
+            buildSeeded(engine, tree, seed);
+            buildSeeded(reference, tree, seed);
+            CHECK(sameFrames(engine, reference, TICKS));
+
+            for (uint8_t group = 0; group < 60; group += 6) {
+                const uint8_t add = group + 1, pulse = group + 3, cycle = group + 4, color = group + 5;
+                engine.applyPatch(std::vector<uint8_t>{
+                    PATCH_VERSION,
+                    PatchCommandIds::RemoveColorLink, add, 0, 1,
+                    PatchCommandIds::RemoveTriggerLink, pulse, 0, 0,
+                    PatchCommandIds::AddTriggerLink, cycle, 0, pulse, 0, 0, 0,
+                    PatchCommandIds::AddColorLink, color, 0, add, 0, 0, 1});
+                CHECK(sameFrames(engine, reference, 20));
+            }
+            CHECK(engine.saveState() == reference.saveState());
+        }
+    }
+
+    /**
+     * @brief Memory of nodes, links and input lists removed by a patch is reused, a long editing session does not grow
+     * the arena.
+     */
+    void checkMemoryReuse()
+    {
+        const auto tree = generateTree(1, 60);
+        Engine     engine;
+        engine.build(tree);
+
+        // DMX fixture reading a color, added and removed again, and a link added to and removed from the fixture
+        const std::vector<uint8_t> add = {
+            PATCH_VERSION,
+            PatchCommandIds::AddNode, TypeIds::DsDmxRgb, 100, 0,
+            PatchCommandIds::AddNode, TypeIds::SrColor, 1, 0, 2, 0, 3, 0,
+            PatchCommandIds::AddColorLink, 61, 0, 60, 0, 0, 0,
+            PatchCommandIds::AddColorLink, 61, 0, 60, 0, 0, 1};
+        const std::vector<uint8_t> unlink = {PATCH_VERSION, PatchCommandIds::RemoveColorLink, 60, 0, 1};
+        const std::vector<uint8_t> remove = {
+            PATCH_VERSION, PatchCommandIds::RemoveNode, 61, 0, PatchCommandIds::RemoveNode, 60, 0};
+        const std::vector<uint8_t> rejected = {
+            PATCH_VERSION, PatchCommandIds::AddNode, TypeIds::MxAdd, PatchCommandIds::AddColorLink, 60, 0, 60, 0, 0, 0};
+
+        const auto cycle = [&] {
+            engine.applyPatch(add);
+            std::ignore = engine.tick();
+            engine.applyPatch(unlink);
+            engine.applyPatch(remove);
+            try {
+                engine.applyPatch(rejected);
+            } catch (const std::exception&) {}
+            std::ignore = engine.tick();
+        };
+        for (int i = 0; i < 100; i++)
+            cycle();
+        const auto allocations = large_allocations.load();
+        for (int i = 0; i < 10000; i++)
+            cycle();
+        CHECK(large_allocations.load() == allocations);
+    }
+}
+
+int main()
+{
+    checkUnconnectedNode();
+    checkRollback();
+    checkRelink();
+    checkMemoryReuse();
+    return Check::result();
+}
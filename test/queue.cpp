@@ -0,0 +1,86 @@
+#include <array>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <SparkWeaverCore.h>
+
+#include "check.h"
+
+using namespace SparkWeaverCore;
+
+namespace {
+    constexpr size_t   CAPACITY  = 64;
+    constexpr size_t   PRODUCERS = 4;
+    constexpr uint32_t PUSHES    = 200000;
+
+    /**
+     * @brief One thread sees its values in push order, a full queue refuses and an empty one has nothing, over many
+     * laps of the cells.
+     */
+    void checkSingleThread()
+    {
+        MpscQueue<uint32_t, CAPACITY> queue;
+        uint32_t                      value = 0;
+        CHECK(!queue.pop(value));
+
+        uint32_t pushed = 0, popped = 0;
+        auto     in_order = true, bounded = true;
+        for (int lap = 0; lap < 10; lap++) {
+            // Fill from a different offset every lap so the positions wrap at every cell
+            const auto count = CAPACITY - lap % 3;
+            for (size_t i = 0; i < count; i++)
+                bounded = queue.push(pushed++) && bounded;
+            if (count == CAPACITY) bounded = !queue.push(UINT32_MAX) && bounded;
+            for (size_t i = 0; i < count; i++)
+                in_order = queue.pop(value) && value == popped++ && in_order;
+            in_order = !queue.pop(value) && in_order;
+        }
+        CHECK(bounded);
+        CHECK(in_order);
+    }
+
+    /**
+     * @brief Values of each producer arrive in the order that producer pushed them, none lost or repeated.
+     */
+    void checkProducers()
+    {
+        MpscQueue<uint32_t, CAPACITY> queue;
+        std::vector<std::jthread>     producers;
+        for (uint32_t producer = 0; producer < PRODUCERS; producer++) {
+            producers.emplace_back([&queue, producer] {
+                for (uint32_t i = 0; i < PUSHES; i++) {
+                    while (!queue.push(producer << 24 | i))
+                        std::this_thread::yield();
+                }
+            });
+        }
+
+        std::array<uint32_t, PRODUCERS> next{};
+        auto                            in_order = true;
+        for (uint32_t received = 0; received < PRODUCERS * PUSHES;) {
+            uint32_t value;
+            if (!queue.pop(value)) {
+                std::this_thread::yield();
+                continue;
+            }
+            const auto producer = value >> 24;
+            in_order            = producer < PRODUCERS && (value & 0xFFFFFF) == next[producer]++ && in_order;
+            received++;
+        }
+        producers.clear();
+
+        uint32_t value;
+        CHECK(in_order);
+        CHECK(!queue.pop(value));
+        for (const auto count : next)
+            CHECK(count == PUSHES);
+    }
+}
+
+int main()
+{
+    checkSingleThread();
+    checkProducers();
+    return Check::result();
+}
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include <SparkWeaverCore.h>
+
+#include "check.h"
+#include "trees.h"
+
+using namespace Trees;
+
+namespace {
+    constexpr size_t   FRAME_SIZE = 40;
+    constexpr size_t   SLOTS      = 5;
+    constexpr uint32_t FRAMES     = 100000;
+
+    void stamp(const std::span<uint8_t> slot, const uint32_t frame)
+    {
+        for (size_t i = 0; i < slot.size(); i++)
+            slot[i] = static_cast<uint8_t>(frame * 7 + i);
+    }
+
+    bool hasStamp(const std::span<const uint8_t> slot, const uint32_t frame)
+    {
+        for (size_t i = 0; i < slot.size(); i++)
+            if (slot[i] != static_cast<uint8_t>(frame * 7 + i)) return false;
+        return true;
+    }
+
+    /**
+     * @brief A full ring has no slot to write and an empty one no frame to read, frames come out in order over many
+     * laps with the ring filled to a different level every lap.
+     */
+    void checkFullAndEmpty()
+    {
+        FrameRing ring(FRAME_SIZE, SLOTS);
+        CHECK(ring.readSlot().empty());
+        CHECK(ring.getFrameCount() == 0);
+
+        uint32_t written = 0, read = 0;
+        auto     bounded = true, in_order = true;
+        for (size_t lap = 0; lap < 20; lap++) {
+            const auto count = lap % 3 == 0 ? SLOTS : lap % SLOTS + 1;
+            for (size_t i = 0; i < count; i++) {
+                const auto slot = ring.writeSlot();
+                bounded         = slot.size() == FRAME_SIZE && bounded;
+                stamp(slot, written++);
+                ring.commitWrite();
+            }
+            bounded = ring.getFrameCount() == count && bounded;
+            if (count == SLOTS) bounded = ring.writeSlot().empty() && bounded;
+            for (size_t i = 0; i < count; i++) {
+                in_order = hasStamp(ring.readSlot(), read++) && in_order;
+                ring.commitRead();
+            }
+            in_order = ring.readSlot().empty() && in_order;
+        }
+        CHECK(bounded);
+        CHECK(in_order);
+
+        FrameRing single(FRAME_SIZE, 0);
+        CHECK(single.getSlotCount() == 1);
+        CHECK(!single.writeSlot().empty());
+        single.commitWrite();
+        CHECK(single.writeSlot().empty());
+    }
+
+    /**
+     * @brief Frames written on one thread are read whole and in order on another.
+     */
+    void checkThreads()
+    {
+        FrameRing    ring(FRAME_SIZE, SLOTS);
+        std::jthread renderer([&ring] {
+            for (uint32_t frame = 0; frame < FRAMES;) {
+                const auto slot = ring.writeSlot();
+                if (slot.empty()) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                stamp(slot, frame++);
+                ring.commitWrite();
+            }
+        });
+
+        auto in_order = true;
+        for (uint32_t frame = 0; frame < FRAMES;) {
+            const auto slot = ring.readSlot();
+            if (slot.empty()) {
+                std::this_thread::yield();
+                continue;
+            }
+            in_order = hasStamp(slot, frame++) && in_order;
+            ring.commitRead();
+        }
+        CHECK(in_order);
+    }
+
+    /**
+     * @brief Frames rendered ahead into the ring are the frames ticking returns.
+     */
+    void checkRenderAhead()
+    {
+        Random     random(1);
+        TreeWriter writer;
+        mixedTree(writer, random, 40);
+        const auto tree = writer.bytes();
+
+        Engine engine, reference;
+        engine.setSeed(1);
+        engine.build(tree);
+        reference.setSeed(1);
+        reference.build(tree);
+
+        const auto frame_size = reference.getUniverseCount() * DMX_PACKET_SIZE;
+        FrameRing  ring(frame_size, SLOTS);
+        size_t     waiting = 0;
+        auto       same    = true;
+        for (size_t round = 0; round < 100; round++) {
+            // Frames left in the ring by the previous round keep their slots
+            same = engine.renderAhead(ring) == SLOTS - waiting && same;
+
+            const auto reads = round % SLOTS + 1;
+            for (size_t i = 0; i < reads; i++) {
+                same = std::ranges::equal(ring.readSlot(), reference.tickUniverses()) && same;
+                ring.commitRead();
+            }
+            waiting = SLOTS - reads;
+        }
+        CHECK(same);
+    }
+}
+
+int main()
+{
+    checkFullAndEmpty();
+    checkThreads();
+    checkRenderAhead();
+    return Check::result();
+}
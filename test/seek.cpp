@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <span>
+#include <tuple>
+#include <vector>
+
+#include <SparkWeaverCore.h>
+
+#include "check.h"
+#include "trees.h"
+
+using namespace Trees;
+
+namespace {
+    std::atomic<size_t> allocations = 0;
+}
+
+void* operator new(const size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (const auto p = std::malloc(size == 0 ? 1 : size)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+    constexpr int TREES = 20;
+    constexpr int TICKS = 2000;
+
+    using Generator = std::function<void(TreeWriter&, Random&, int)>;
+
+    const std::vector<Generator> generators = {triggerTree, randomTree, sparseTree, mixedTree, allTypesTree};
+
+    std::vector<uint8_t> generateTree(const Generator& generator, const int seed)
+    {
+        Random     random(seed);
+        TreeWriter writer;
+        generator(writer, random, 90);
+        return writer.bytes();
+    }
+
+    void buildSeeded(Engine& engine, const std::span<const uint8_t> tree, const int seed)
+    {
+        engine.setSeed(seed);
+        engine.build(tree);
+    }
+
+    void tickTo(Engine& engine, const uint32_t tick)
+    {
+        while (engine.getTick() < tick)
+            std::ignore = engine.tick();
+    }
+
+    /**
+     * @brief Seeking gives the frame and state of ticking there, forward and back, neither ticks nor seeks allocate.
+     */
+    void checkSeek(const Generator& generator)
+    {
+        for (int seed = 0; seed < TREES; seed++) {
+            const auto tree   = generateTree(generator, seed);
+            const auto target = static_cast<uint32_t>(TICKS / 2 + seed * 37);
+            Engine     engine;
+            buildSeeded(engine, tree, seed);
+
+            // Forward from tick 0, then back after ticking past the target
+            for (const auto from : {0, TICKS}) {
+                Engine fresh;
+                buildSeeded(fresh, tree, seed);
+                tickTo(fresh, target);
+                const auto ticked = allocations.load();
+                tickTo(engine, from);
+                CHECK(allocations.load() == ticked); // Trigger events fit the schedule reserved by the build
+
+                const auto allocated = allocations.load();
+                engine.seek(target);
+                CHECK(allocations.load() == allocated);
+                CHECK(engine.getTick() == target);
+                for (int i = 0; i < 50; i++)
+                    CHECK(std::ranges::equal(engine.tickUniverses(), fresh.tickUniverses()));
+                CHECK(engine.saveState() == fresh.saveState());
+            }
+        }
+    }
+}
+
+int main()
+{
+    for (const auto& generator : generators)
+        checkSeek(generator);
+    return Check::result();
+}
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <tuple>
+#include <vector>
+
+#include <SparkWeaverCore.h>
+
+#include "check.h"
+#include "trees.h"
+
+using namespace Trees;
+
+namespace {
+    constexpr int TREES = 40;
+    constexpr int TICKS = 300;
+
+    std::vector<uint8_t> generateTree(const int seed, const int nodes_count)
+    {
+        Random     random(seed);
+        TreeWriter writer;
+        allTypesTree(writer, random, nodes_count);
+        return writer.bytes();
+    }
+
+    void buildSeeded(Engine& engine, const std::span<const uint8_t> tree, const int seed)
+    {
+        engine.setSeed(seed);
+        engine.build(tree);
+    }
+
+    bool sameFrames(Engine& engine, Engine& reference, const int ticks)
+    {
+        for (int i = 0; i < ticks; i++) {
+            if (!std::ranges::equal(engine.tickUniverses(), reference.tickUniverses())) return false;
+            for (size_t universe = 0; universe < reference.getUniverseCount(); universe++) {
+                const auto changed           = engine.getChangedChannels(universe);
+                const auto reference_changed = reference.getChangedChannels(universe);
+                if (changed.start != reference_changed.start || changed.end != reference_changed.end) return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief The same tree staged with carried state continues exactly where plain ticking is.
+     */
+    void checkCarryState()
+    {
+        for (int seed = 0; seed < TREES; seed++) {
+            const auto tree = generateTree(seed, 120);
+            Engine     engine, reference;
+            buildSeeded(engine, tree, seed);
+            buildSeeded(reference, tree, seed);
+            CHECK(sameFrames(engine, reference, TICKS));
+
+            engine.stageBuild(tree, true);
+            CHECK(engine.isBuildStaged());
+            CHECK(sameFrames(engine, reference, 1));
+            CHECK(!engine.isBuildStaged());
+            CHECK(sameFrames(engine, reference, TICKS));
+            CHECK(engine.saveState() == reference.saveState());
+        }
+    }
+
+    /**
+     * @brief Another tree staged without state starts from tick 0, as if built on its own.
+     */
+    void checkFreshTree()
+    {
+        for (int seed = 0; seed < TREES; seed++) {
+            const auto tree = generateTree(seed, 120), next_tree = generateTree(seed + TREES, 80);
+            Engine     engine, reference;
+            buildSeeded(engine, tree, seed);
+            buildSeeded(reference, next_tree, seed);
+            for (int i = 0; i < TICKS; i++)
+                std::ignore = engine.tick();
+
+            engine.stageBuild(next_tree);
+            for (int i = 0; i < TICKS; i++)
+                CHECK(std::ranges::equal(engine.tickUniverses(), reference.tickUniverses()));
+            CHECK(engine.exportTree() == reference.exportTree());
+        }
+    }
+
+    /**
+     * @brief A build staged right after a swap leaves the frame of the tick before the swap alone until the next tick.
+     */
+    void checkFrameKept()
+    {
+        for (int seed = 0; seed < TREES; seed++) {
+            Random     random(seed);
+            TreeWriter writer;
+            mixedTree(writer, random, 60); // Every fixture adds a constant color, frames are never dark
+            const auto tree = writer.bytes();
+            Engine     engine;
+            buildSeeded(engine, tree, seed);
+            for (int i = 0; i < TICKS; i++)
+                std::ignore = engine.tick();
+
+            const auto                 universes = engine.tickUniverses();
+            const std::vector<uint8_t> frame(universes.begin(), universes.end());
+            engine.stageBuild(tree);
+            std::ignore = engine.tick(); // Swap
+            engine.stageBuild(tree);
+            CHECK(std::ranges::any_of(frame, [](const uint8_t value) { return value != 0; }));
+            CHECK(std::ranges::equal(frame, universes));
+        }
+    }
+
+    /**
+     * @brief A build staged on the tick after a swap is swapped in at the next tick, before the worker takes back the
+     * retired tree.
+     */
+    void checkBuildsInTurn()
+    {
+        for (int seed = 0; seed < TREES; seed++) {
+            const auto tree = generateTree(seed, 120), next_tree = generateTree(seed + TREES, 80),
+                       last_tree = generateTree(seed + 2 * TREES, 100);
+            Engine engine, reference;
+            buildSeeded(engine, tree, seed);
+            buildSeeded(reference, last_tree, seed);
+            std::ignore = engine.tick();
+
+            engine.stageBuild(next_tree);
+            std::ignore = engine.tick(); // Swap, the previous tree is retiring
+            engine.stageBuild(last_tree);
+            for (int i = 0; i < TICKS; i++)
+                CHECK(std::ranges::equal(engine.tickUniverses(), reference.tickUniverses()));
+            CHECK(!engine.isBuildStaged());
+            CHECK(engine.exportTree() == reference.exportTree());
+        }
+    }
+}
+
+int main()
+{
+    checkCarryState();
+    checkFreshTree();
+    checkFrameKept();
+    checkBuildsInTurn();
+    return Check::result();
+}
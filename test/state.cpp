@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <tuple>
+#include <vector>
+
+#include <SparkWeaverCore.h>
+
+#include "check.h"
+#include "trees.h"
+
+using namespace Trees;
+
+namespace {
+    constexpr int TREES = 20;
+    constexpr int TICKS = 500;
+
+    using Generator = std::function<void(TreeWriter&, Random&, int)>;
+
+    const std::vector<Generator> generators = {triggerTree, randomTree, sparseTree, mixedTree, allTypesTree};
+
+    std::vector<uint8_t> generateTree(const Generator& generator, const int seed, const int nodes_count = 90)
+    {
+        Random     random(seed);
+        TreeWriter writer;
+        generator(writer, random, nodes_count);
+        return writer.bytes();
+    }
+
+    void buildSeeded(Engine& engine, const std::span<const uint8_t> tree, const int seed)
+    {
+        engine.setSeed(seed);
+        engine.build(tree);
+    }
+
+    void tickFor(Engine& engine, const int ticks)
+    {
+        for (int i = 0; i < ticks; i++)
+            std::ignore = engine.tick();
+    }
+
+    bool sameFrames(Engine& engine, Engine& reference, const int ticks)
+    {
+        for (int i = 0; i < ticks; i++)
+            if (!std::ranges::equal(engine.tickUniverses(), reference.tickUniverses())) return false;
+        return true;
+    }
+
+    bool restored(Engine& engine, const std::span<const uint8_t> state)
+    {
+        try {
+            engine.restoreState(state);
+        } catch (const std::exception&) {
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief An engine restored from a snapshot continues like the engine it was taken from, whatever its own seed and
+     * clock.
+     */
+    void checkRestore(const Generator& generator)
+    {
+        for (int seed = 0; seed < TREES; seed++) {
+            const auto tree = generateTree(generator, seed);
+            Engine     engine, reference;
+            buildSeeded(engine, tree, seed + TREES);
+            buildSeeded(reference, tree, seed);
+            tickFor(engine, 37);
+            tickFor(reference, TICKS + seed * 13);
+
+            const auto state = reference.saveState();
+            CHECK(state.front() == STATE_VERSION);
+            CHECK(restored(engine, state));
+            CHECK(engine.getTick() == reference.getTick());
+            CHECK(engine.saveState() == state);
+            CHECK(sameFrames(engine, reference, TICKS));
+            CHECK(engine.saveState() == reference.saveState());
+        }
+    }
+
+    /**
+     * @brief Cut off, corrupt or foreign snapshots are rejected and the engine keeps its state.
+     */
+    void checkRejected(const Generator& generator)
+    {
+        for (int seed = 0; seed < TREES; seed += 4) {
+            const auto tree = generateTree(generator, seed);
+            Engine     engine, reference, other;
+            buildSeeded(engine, tree, seed);
+            buildSeeded(reference, tree, seed);
+            buildSeeded(other, generateTree(generator, seed, 60), seed); // Fewer nodes of the same types
+            tickFor(engine, TICKS);
+            tickFor(reference, TICKS);
+            tickFor(other, TICKS);
+
+            const auto state = reference.saveState();
+            for (size_t size = 0; size < state.size(); size++)
+                CHECK(!restored(engine, std::span(state).first(size)));
+            auto longer = state;
+            longer.push_back(0);
+            CHECK(!restored(engine, longer));
+            auto version = state;
+            version[0]   = STATE_VERSION - 1;
+            CHECK(!restored(engine, version));
+            CHECK(!restored(engine, other.saveState()));
+
+            CHECK(engine.saveState() == state);
+            CHECK(sameFrames(engine, reference, TICKS));
+        }
+    }
+}
+
+int main()
+{
+    for (const auto& generator : generators) {
+        checkRestore(generator);
+        checkRejected(generator);
+    }
+    return Check::result();
+}
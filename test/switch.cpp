@@ -0,0 +1,102 @@
+#include <array>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+#include <SparkWeaverCore.h>
+
+#include "check.h"
+#include "trees.h"
+
+using namespace Trees;
+
+namespace {
+    constexpr uint32_t TICKS         = 5000;
+    constexpr uint16_t SWITCH_CYCLE  = 200;
+    constexpr uint16_t STROBE_CYCLE  = 1000;
+    constexpr uint16_t STROBE_LENGTH = 1000;
+
+    using Rgb = std::array<uint8_t, 3>;
+
+    constexpr Rgb RED   = {0xFF, 0, 0};
+    constexpr Rgb WHITE = {0xFF, 0xFF, 0xFF};
+    constexpr Rgb BLACK = {0, 0, 0};
+
+    /**
+     * @brief Switch between red and a long strobe, the strobe is triggered at tick 50 while red is selected.
+     */
+    std::vector<uint8_t> switchTree()
+    {
+        TreeWriter writer;
+        const auto red          = writer.node(TypeIds::SrColor, {RED[0], RED[1], RED[2]});
+        const auto white        = writer.node(TypeIds::SrColor, {WHITE[0], WHITE[1], WHITE[2]});
+        const auto strobe       = writer.node(TypeIds::FxStrobe, {STROBE_LENGTH});
+        const auto strobe_cycle = writer.node(TypeIds::TrCycle, {STROBE_CYCLE, STROBE_CYCLE - 50});
+        const auto switch_cycle = writer.node(TypeIds::TrCycle, {SWITCH_CYCLE, SWITCH_CYCLE / 2});
+        const auto mix          = writer.node(TypeIds::MxSwitch);
+        const auto dmx          = writer.node(TypeIds::DsDmxRgb, {1});
+        std::ignore             = writer.color(white, strobe);
+        std::ignore             = writer.trigger(strobe_cycle, strobe);
+        std::ignore             = writer.color(red, mix);
+        std::ignore             = writer.color(strobe, mix);
+        std::ignore             = writer.trigger(switch_cycle, mix);
+        std::ignore             = writer.color(mix, dmx);
+        return writer.bytes();
+    }
+
+    /**
+     * @brief Frames where the strobe only sees triggers at ticks its input is selected.
+     */
+    std::vector<Rgb> expectedFrames()
+    {
+        std::vector<Rgb> frames;
+        auto             flash_tick = UINT32_MAX;
+        for (uint32_t tick = 0; tick < TICKS; tick++) {
+            const auto selected = (tick + SWITCH_CYCLE / 2) / SWITCH_CYCLE % 2 == 1;
+            if (selected && (tick + STROBE_CYCLE - 50) % STROBE_CYCLE == 0) flash_tick = tick;
+            const auto lit = tick >= flash_tick && tick < flash_tick + STROBE_LENGTH;
+            frames.push_back(selected ? (lit ? WHITE : BLACK) : RED);
+        }
+        return frames;
+    }
+
+    Rgb frameColor(const uint8_t* p_frame) { return {p_frame[1], p_frame[2], p_frame[3]}; }
+
+    /**
+     * @brief Nodes behind an input that is not selected are not evaluated and wait until it is selected again.
+     */
+    void checkUnselectedWaits()
+    {
+        const auto expected = expectedFrames();
+        Engine     engine;
+        engine.build(switchTree());
+
+        auto same = true;
+        for (uint32_t tick = 0; tick < TICKS; tick++)
+            same = frameColor(engine.tick()) == expected[tick] && same;
+        CHECK(same);
+        CHECK(expected[150] == BLACK);
+        CHECK(expected[1060] == WHITE);
+    }
+
+    /**
+     * @brief Seeking skips the nodes behind an input that is not selected the same way.
+     */
+    void checkSeek()
+    {
+        const auto expected = expectedFrames();
+        Engine     engine;
+        engine.build(switchTree());
+        for (uint32_t tick = 37; tick < TICKS; tick += 173) {
+            engine.seek(tick);
+            CHECK(frameColor(engine.tick()) == expected[tick]);
+        }
+    }
+}
+
+int main()
+{
+    checkUnselectedWaits();
+    checkSeek();
+    return Check::result();
+}
@@ -0,0 +1,314 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <SparkWeaverCore.h>
+
+/**
+ * @brief Synthetic node trees shared by the benchmark and the tests.
+ */
+namespace Trees {
+    using namespace SparkWeaverCore;
+    using Random = std::mt19937;
+
+    /**
+     * @class TreeWriter
+     * @brief Serializes a node tree in the current tree format, links that would exceed node limits are skipped.
+     */
+    class TreeWriter {
+        struct Link {
+            uint16_t out_node_index;
+            uint16_t in_node_index;
+            uint8_t  out_index;
+            uint8_t  in_index;
+        };
+
+        struct NodeLinks {
+            const NodeConfig* p_config;
+            uint8_t           color_inputs    = 0;
+            uint8_t           trigger_inputs  = 0;
+            uint8_t           color_outputs   = 0;
+            uint8_t           trigger_outputs = 0;
+        };
+
+        std::vector<uint8_t>   nodes{};
+        std::vector<NodeLinks> node_links{};
+        std::vector<Link>      color_links{};
+        std::vector<Link>      trigger_links{};
+
+        static void writeShort(std::vector<uint8_t>& bytes, const uint16_t value)
+        {
+            bytes.push_back(value & 0xFF);
+            bytes.push_back(value >> 8);
+        }
+
+        static void writeLinks(std::vector<uint8_t>& bytes, const uint8_t command, const std::vector<Link>& links)
+        {
+            bytes.push_back(command);
+            writeShort(bytes, links.size());
+            for (const auto& [out_node_index, in_node_index, out_index, in_index] : links) {
+                writeShort(bytes, out_node_index);
+                writeShort(bytes, in_node_index);
+                bytes.push_back(out_index);
+                bytes.push_back(in_index);
+            }
+        }
+
+        // Sequences send to a single output index at a time, every link gets its own index
+        static bool indexedOutputs(const NodeConfig& config)
+        {
+            return config.type_id == TypeIds::MxSequence || config.type_id == TypeIds::TrSequence;
+        }
+
+    public:
+        static const NodeConfig& config(const uint8_t type_id)
+        {
+            for (const auto p_config : Engine::getNodeConfigs())
+                if (p_config->type_id == type_id) return *p_config;
+            std::abort();
+        }
+
+        /**
+         * @brief Add a node, missing parameters are written with their default value.
+         * @return Node index
+         */
+        uint16_t node(const uint8_t type_id, const std::vector<uint16_t>& params = {})
+        {
+            const auto& node_config = config(type_id);
+            nodes.push_back(type_id);
+            for (size_t i = 0; i < node_config.params_count; i++)
+                writeShort(nodes, i < params.size() ? params[i] : node_config.params[i].default_value);
+            node_links.push_back({&node_config});
+            return node_links.size() - 1;
+        }
+
+        /**
+         * @brief Add a node with random parameters, limited to 1000 so effects keep changing during a benchmark.
+         * @return Node index
+         */
+        uint16_t randomNode(const uint8_t type_id, Random& random)
+        {
+            const auto&           node_config = config(type_id);
+            std::vector<uint16_t> params;
+            for (size_t i = 0; i < node_config.params_count; i++) {
+                const auto& param = node_config.params[i];
+                params.push_back(std::uniform_int_distribution<int>(param.min, std::min<int>(param.max, 1000))(random));
+            }
+            return node(type_id, params);
+        }
+
+        /**
+         * @brief Link color output to the next free color input.
+         * @return False if the output node has no color output or either node is out of connections
+         */
+        bool color(const uint16_t out_node, const uint16_t in_node)
+        {
+            auto& out = node_links[out_node];
+            auto& in  = node_links[in_node];
+            if (out.p_config->color_outputs == ColorOutputs::DISABLED || out.color_outputs >= MAXIMUM_CONNECTIONS ||
+                in.color_inputs >= in.p_config->color_inputs_max)
+                return false;
+            const uint8_t out_index = indexedOutputs(*out.p_config) ? out.color_outputs : 0;
+            color_links.push_back({out_node, in_node, out_index, in.color_inputs++});
+            out.color_outputs++;
+            return true;
+        }
+
+        /**
+         * @brief Link trigger output to the next free trigger input.
+         * @return False if the output node has no trigger output or either node is out of connections
+         */
+        bool trigger(const uint16_t out_node, const uint16_t in_node)
+        {
+            auto& out = node_links[out_node];
+            auto& in  = node_links[in_node];
+            if (out.p_config->trigger_outputs == TriggerOutputs::DISABLED ||
+                out.trigger_outputs >= MAXIMUM_CONNECTIONS || in.trigger_inputs >= in.p_config->trigger_inputs_max)
+                return false;
+            const uint8_t out_index = indexedOutputs(*out.p_config) ? out.trigger_outputs : 0;
+            trigger_links.push_back({out_node, in_node, out_index, in.trigger_inputs++});
+            out.trigger_outputs++;
+            return true;
+        }
+
+        [[nodiscard]] size_t nodesCount() const noexcept { return node_links.size(); }
+        [[nodiscard]] size_t linksCount() const noexcept { return color_links.size() + trigger_links.size(); }
+
+        [[nodiscard]] std::vector<uint8_t> bytes() const
+        {
+            std::vector<uint8_t> bytes;
+            bytes.reserve(1 + nodes.size() + 6 + (color_links.size() + trigger_links.size()) * 6);
+            bytes.push_back(TREE_VERSION);
+            bytes.insert(bytes.end(), nodes.begin(), nodes.end());
+            writeLinks(bytes, CommandIds::ColorLinks, color_links);
+            writeLinks(bytes, CommandIds::TriggerLinks, trigger_links);
+            return bytes;
+        }
+    };
+
+    inline uint16_t randomParam(Random& random, const int min, const int max)
+    {
+        return std::uniform_int_distribution(min, max)(random);
+    }
+
+    inline uint16_t randomAddress(Random& random) { return randomParam(random, 1, 510); }
+
+    /**
+     * @brief Groups of a color breathing into every input of a DMX fixture, 3 nodes and 33 links per group.
+     */
+    inline void wideTree(TreeWriter& writer, Random& random, const int nodes_count)
+    {
+        for (int i = 0; i + 3 <= nodes_count; i += 3) {
+            const auto dmx     = writer.node(TypeIds::DsDmxRgb, {randomAddress(random)});
+            const auto breathe = writer.node(TypeIds::FxBreathe, {randomParam(random, 40, 800)});
+            const auto color   = writer.node(TypeIds::SrColor, {0xFF, randomParam(random, 0, 0xFF), 0x40});
+            writer.color(color, breathe);
+            while (writer.color(breathe, dmx)) {}
+        }
+    }
+
+    /**
+     * @brief Chains of up to 128 alternating breathe and subtract nodes behind a DMX fixture.
+     */
+    inline void deepTree(TreeWriter& writer, Random& random, const int nodes_count)
+    {
+        constexpr int depth = 128;
+        for (int i = 0; i + 4 <= nodes_count; i += depth + 3) {
+            const auto dmx    = writer.node(TypeIds::DsDmxRgb, {randomAddress(random)});
+            const auto offset = writer.node(TypeIds::SrColor, {1, 1, 1});
+            auto       input  = dmx;
+            for (int j = 0; j < depth && i + j + 3 < nodes_count; j++) {
+                const auto node = j % 2 == 0 ? writer.node(TypeIds::FxBreathe, {randomParam(random, 40, 800)})
+                                             : writer.node(TypeIds::MxSubtract);
+                writer.color(node, input);
+                if (j % 2 == 1) writer.color(offset, node);
+                input = node;
+            }
+            writer.color(writer.node(TypeIds::SrColor, {0xFF, 0xFF, 0xFF}), input);
+        }
+    }
+
+    /**
+     * @brief Interval triggers combined through a delay, gates and a sequence into a pulse and a strobe, 10 nodes per
+     * group.
+     */
+    inline void triggerTree(TreeWriter& writer, Random& random, const int nodes_count)
+    {
+        for (int i = 0; i + 10 <= nodes_count; i += 10) {
+            const auto dmx      = writer.node(TypeIds::DsDmxRgb, {randomAddress(random)});
+            const auto add      = writer.node(TypeIds::MxAdd);
+            const auto pulse    = writer.node(TypeIds::FxPulse, {randomParam(random, 1, 10), 1, 20, 1});
+            const auto strobe   = writer.node(TypeIds::FxStrobe, {randomParam(random, 1, 4)});
+            const auto sequence = writer.node(TypeIds::TrSequence);
+            const auto gate_or  = writer.node(TypeIds::MxOr);
+            const auto gate_and = writer.node(TypeIds::MxAnd);
+            const auto delay    = writer.node(TypeIds::TrDelay, {randomParam(random, 1, 0xFF)});
+            const auto cycle    = writer.node(TypeIds::TrCycle, {randomParam(random, 2, 400)});
+            const auto color    = writer.node(TypeIds::SrColor, {0xFF, 0x80, 0x40});
+            writer.color(add, dmx);
+            writer.color(pulse, add);
+            writer.color(strobe, add);
+            writer.color(color, pulse);
+            writer.color(color, strobe);
+            writer.trigger(sequence, pulse);
+            writer.trigger(sequence, strobe);
+            writer.trigger(gate_or, sequence);
+            writer.trigger(delay, gate_or);
+            writer.trigger(gate_and, gate_or);
+            writer.trigger(cycle, gate_and);
+            writer.trigger(delay, gate_and);
+            writer.trigger(cycle, delay);
+        }
+    }
+
+    /**
+     * @brief Random interval triggers through stochastic gates into random sequences and switches, 9 nodes per group.
+     */
+    inline void randomTree(TreeWriter& writer, Random& random, const int nodes_count)
+    {
+        for (int i = 0; i + 9 <= nodes_count; i += 9) {
+            const auto dmx       = writer.node(TypeIds::DsDmxRgb, {randomAddress(random)});
+            const auto sequence  = writer.node(TypeIds::MxSequence, {1});
+            const auto color_sw  = writer.node(TypeIds::MxSwitch, {1});
+            const auto trig_seq  = writer.node(TypeIds::TrSequence, {1});
+            const auto chance    = writer.node(TypeIds::TrChance);
+            const auto interval  = writer.node(TypeIds::TrRandom, {randomParam(random, 0, 20), 200});
+            const auto red       = writer.node(TypeIds::SrColor, {0xFF, 0, 0});
+            const auto green     = writer.node(TypeIds::SrColor, {0, 0xFF, 0});
+            const auto blue      = writer.node(TypeIds::SrColor, {0, 0, 0xFF});
+            for (int j = 0; j < 3; j++)
+                writer.color(sequence, dmx);
+            writer.color(color_sw, sequence);
+            writer.color(red, color_sw);
+            writer.color(green, color_sw);
+            writer.color(blue, color_sw);
+            writer.trigger(trig_seq, sequence);
+            writer.trigger(trig_seq, color_sw);
+            writer.trigger(chance, trig_seq);
+            writer.trigger(interval, chance);
+        }
+    }
+
+    /**
+     * @brief Slow cycles through long delays into pulses, so most ticks have no trigger event, 5 nodes per group.
+     */
+    inline void sparseTree(TreeWriter& writer, Random& random, const int nodes_count)
+    {
+        for (int i = 0; i + 5 <= nodes_count; i += 5) {
+            const auto dmx   = writer.node(TypeIds::DsDmxRgb, {randomAddress(random)});
+            const auto pulse = writer.node(TypeIds::FxPulse, {randomParam(random, 1, 10), 1, 20, 1});
+            const auto delay = writer.node(TypeIds::TrDelay, {randomParam(random, 0x100, 0x2000)});
+            const auto cycle =
+                writer.node(TypeIds::TrCycle, {randomParam(random, 400, 4000), randomParam(random, 0, 4000)});
+            const auto color = writer.node(TypeIds::SrColor, {0xFF, 0xFF, 0xFF});
+            writer.color(pulse, dmx);
+            writer.color(color, pulse);
+            writer.trigger(delay, pulse);
+            writer.trigger(cycle, delay);
+        }
+    }
+
+    /**
+     * @brief Groups of a color pulsed by an interval trigger, breathing and mixed back into the source, 6 nodes and 6
+     * links per group.
+     */
+    inline void mixedTree(TreeWriter& writer, Random& random, const int nodes_count)
+    {
+        for (int i = 0; i + 6 <= nodes_count; i += 6) {
+            const auto dmx     = writer.node(TypeIds::DsDmxRgb, {randomAddress(random)});
+            const auto add     = writer.node(TypeIds::MxAdd);
+            const auto breathe = writer.node(TypeIds::FxBreathe, {randomParam(random, 100, 400), 0, 0x80});
+            const auto pulse   = writer.node(TypeIds::FxPulse, {5, 1, 40, 1});
+            const auto cycle   = writer.node(TypeIds::TrCycle, {randomParam(random, 20, 50), 0});
+            const auto color   = writer.node(TypeIds::SrColor, {0xFF, 0x80, randomParam(random, 0, 0xFF)});
+            writer.color(add, dmx);
+            writer.color(breathe, add);
+            writer.color(color, add);
+            writer.color(pulse, breathe);
+            writer.color(color, pulse);
+            writer.trigger(cycle, pulse);
+        }
+    }
+
+    /**
+     * @brief Every registered node type in turn with random parameters, each node reads from up to 4 of the 64 nodes
+     * after it so the tree stays acyclic.
+     */
+    inline void allTypesTree(TreeWriter& writer, Random& random, const int nodes_count)
+    {
+        const auto configs = Engine::getNodeConfigs();
+        for (int i = 0; i < nodes_count; i++)
+            writer.randomNode(configs[i % configs.size()]->type_id, random);
+        for (int i = 0; i + 1 < nodes_count; i++) {
+            for (int j = 0; j < 4; j++) {
+                const auto out = std::min(nodes_count - 1, i + randomParam(random, 1, 64));
+                writer.color(out, i);
+                writer.trigger(out, i);
+            }
+        }
+    }
+}